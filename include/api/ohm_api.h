@@ -2,8 +2,99 @@
 #define OHM_API_H
 
 // Standard library headers
+#include <cstdint>
 #include <string>
 
+// Third-party libraries
+#include <curl/curl.h>
+
+/**
+ * @brief Phases of the last request made by an OHMFetcher, each measured from its start in
+ * microseconds.
+ */
+struct FetchTiming {
+  /**
+   * @brief Time until the host name was resolved.
+   */
+  int64_t dns = 0;
+
+  /**
+   * @brief Time until the connection was established; zero if it was reused.
+   */
+  int64_t connect = 0;
+
+  /**
+   * @brief Time until the first byte of the response arrived.
+   */
+  int64_t firstByte = 0;
+
+  /**
+   * @brief Time until the whole response arrived.
+   */
+  int64_t total = 0;
+};
+
+/**
+ * @brief Long-lived HTTP client for the Open Hardware Monitor endpoint.
+ *
+ * Keeps one cURL handle for the lifetime of the process, so consecutive requests reuse its
+ * connection and DNS cache, and receives every response into the same pre-reserved buffer.
+ *
+ * The fetcher is not synchronized; the caller serializes access.
+ */
+class OHMFetcher {
+public:
+  /**
+   * @brief Gets the singleton instance of OHMFetcher.
+   *
+   * @return OHMFetcher&
+   *   Reference to the singleton instance
+   */
+  static OHMFetcher& getInstance();
+
+  OHMFetcher(const OHMFetcher&) = delete;
+  OHMFetcher& operator=(const OHMFetcher&) = delete;
+
+  /**
+   * @brief Fetches a document.
+   *
+   * @param url
+   *   The OHM endpoint URL
+   *
+   * @return const std::string&
+   *   The response body, empty on failure; valid until the next call
+   */
+  const std::string& fetch(const std::string& url);
+
+  /**
+   * @brief Gets the timing of the last request.
+   *
+   * @return FetchTiming
+   *   Phases of the last request
+   */
+  FetchTiming getLastTiming() const;
+
+private:
+  /**
+   * @brief Creates the cURL handle and reserves the response buffer.
+   */
+  OHMFetcher();
+
+  /**
+   * @brief Releases the cURL handle, closing its connection.
+   */
+  ~OHMFetcher();
+
+  /**
+   * @brief Initial capacity of the response buffer, in bytes.
+   */
+  static constexpr size_t RESPONSE_RESERVE = 64 * 1024;
+
+  CURL* curl;
+  std::string response;
+  FetchTiming lastTiming;
+};
+
 /**
  * Fetches data from Open Hardware Monitor using a given URL.
  *
@@ -3,10 +3,21 @@
 // Standard library headers
 #include <chrono>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 // Third-party libraries
 #include <nlohmann/json.hpp>
 
+/**
+ * @brief Child-index paths from the root of an OHM tree to its sensors, keyed by the device
+ * identifiers and sensor name they were resolved for.
+ *
+ * The hardware tree of a machine does not change between samples, so a path resolved in one
+ * snapshot leads straight to the same sensor in the next one.
+ */
+using SensorPaths = std::unordered_map<std::string, std::vector<size_t>>;
+
 class OHMData {
 public:
   /**
@@ -14,8 +25,11 @@ public:
    *
    * @param data
    *   JSON data from OpenHardwareMonitor containing sensor readings
+   * @param paths
+   *   Sensor paths of the machine, reused and filled by the lookups; nullptr to search the tree on
+   *   every lookup
    */
-  explicit OHMData(const nlohmann::json& data);
+  explicit OHMData(nlohmann::json data, SensorPaths* paths = nullptr);
 
   /**
    * @brief Gets GPU temperature from sensor data.
@@ -44,6 +58,9 @@ public:
   /**
    * @brief Gets current timestamp in Unix format.
    *
+   * Samples taken within the same second share a timestamp; the storage engine keeps them in the
+   * order they were saved and tells them apart by their sequence.
+   *
    * @return long long
    *   Unix timestamp in seconds
    */
@@ -52,27 +69,55 @@ public:
 private:
   nlohmann::json rawData;
   std::chrono::system_clock::time_point timestamp;
+  SensorPaths* paths;
 
   /**
-   * @brief Finds temperature for specific device in JSON data.
+   * @brief Reads a temperature through a cached path, or resolves and caches its path.
    *
-   * @param deviceIdentifier
-   *   String to identify device (e.g., "NVIDIA", "Intel")
+   * @param identifiers
+   *   Strings the device nodes along the path must contain, from the outermost one
    * @param sensorName
    *   Name of the temperature sensor to read
    *
    * @return double
    *   Temperature in Celsius, -1.0 if not found
    */
-  double findComponent(const std::string& deviceIdentifier, const std::string& sensorName) const;
+  double lookup(const std::vector<std::string>& identifiers, const std::string& sensorName) const;
 
   /**
-   * @brief Finds motherboard temperature in JSON data.
+   * @brief Follows a path and reads the sensor it ends at.
+   *
+   * @param path
+   *   Child indices from the root to the sensor
+   * @param identifiers
+   *   Strings the device nodes along the path must contain, from the outermost one
+   * @param sensorName
+   *   Name of the temperature sensor to read
    *
    * @return double
-   *   Motherboard temperature in Celsius, -1.0 if not found
+   *   Temperature in Celsius, -1.0 if the path does not lead to the sensor any more
+   */
+  double readPath(const std::vector<size_t>& path, const std::vector<std::string>& identifiers,
+                  const std::string& sensorName) const;
+
+  /**
+   * @brief Searches the tree for a temperature sensor.
+   *
+   * Descends from every top-level node through the first child whose name contains each
+   * identifier in turn, then reads the sensor from the device reached.
+   *
+   * @param identifiers
+   *   Strings identifying the device nodes, from the outermost one (e.g., "MSI", "Nuvoton")
+   * @param sensorName
+   *   Name of the temperature sensor to read
+   * @param path
+   *   Receives the child indices from the root to the sensor
+   *
+   * @return double
+   *   Temperature in Celsius, -1.0 if not found
    */
-  double findMotherboardTemperature() const;
+  double resolve(const std::vector<std::string>& identifiers, const std::string& sensorName,
+                 std::vector<size_t>& path) const;
 
   /**
    * @brief Extracts temperature value from device's sensor data.
@@ -81,9 +126,23 @@ private:
    *   JSON object containing device sensor data
    * @param sensorName
    *   Name of the temperature sensor to read
+   * @param path
+   *   Receives the indices of the sensor category and of the sensor
    *
    * @return double
    *   Temperature in Celsius, -1.0 if not found
    */
-  double findTemperature(const nlohmann::json& device, const std::string& sensorName) const;
+  double findTemperature(const nlohmann::json& device, const std::string& sensorName,
+                         std::vector<size_t>& path) const;
+
+  /**
+   * @brief Parses the value of a temperature sensor.
+   *
+   * @param sensor
+   *   JSON object of the sensor
+   *
+   * @return double
+   *   Temperature in Celsius
+   */
+  static double parseValue(const nlohmann::json& sensor);
 };
\ No newline at end of file
@@ -8,7 +8,7 @@
 #include "storage/measurement.h"
 
 /**
- * @brief Benchmarks saving measurements to JSON/BSON storage.
+ * @brief Benchmarks saving measurements through the storage engine.
  *
  * @param components
  *   List of component names to record (e.g., "CPU", "GPU", "Motherboard")
@@ -20,11 +20,43 @@
  * @return long long
  *   Total time spent saving in microseconds
  */
-long long benchmarkSaveJson(const std::vector<std::string>& components, int numRecords,
+long long benchmarkSaveEngine(const std::vector<std::string>& components, int numRecords,
+                              int interval);
+
+/**
+ * @brief Benchmarks reading measurements through the storage engine.
+ *
+ * @param components
+ *   List of component names to read
+ * @param numRecords
+ *   Maximum number of records to read per component (0 for all)
+ * @param interval
+ *   Delay in seconds between reading different components (0 for no delay)
+ *
+ * @return long long
+ *   Total time spent reading in microseconds
+ */
+long long benchmarkReadEngine(const std::vector<std::string>& components, int numRecords,
+                              int interval);
+
+/**
+ * @brief Benchmarks saving measurements to BSON files.
+ *
+ * @param components
+ *   List of component names to record
+ * @param numRecords
+ *   Number of batches; each batch writes one record per component
+ * @param interval
+ *   Delay in seconds between batches (0 for no delay)
+ *
+ * @return long long
+ *   Total time spent saving in microseconds
+ */
+long long benchmarkSaveBson(const std::vector<std::string>& components, int numRecords,
                             int interval);
 
 /**
- * @brief Benchmarks reading measurements from JSON/BSON storage.
+ * @brief Benchmarks reading measurements from BSON files.
  *
  * @param components
  *   List of component names to read
@@ -34,9 +66,9 @@ long long benchmarkSaveJson(const std::vector<std::string>& components, int numR
  *   Delay in seconds between reading different components (0 for no delay)
  *
  * @return long long
- *   Total time spent reading in nanoseconds
+ *   Total time spent reading in microseconds
  */
-long long benchmarkReadJson(const std::vector<std::string>& components, int numRecords,
+long long benchmarkReadBson(const std::vector<std::string>& components, int numRecords,
                             int interval);
 
 /**
@@ -66,12 +98,23 @@ long long benchmarkSaveSqlite(const std::vector<std::string>& components, int nu
  *   Delay in seconds between reading different components (0 for no delay)
  *
  * @return long long
- *   Total time spent reading in nanoseconds
+ *   Total time spent reading in microseconds
  */
 long long benchmarkReadSqlite(const std::vector<std::string>& components, int numRecords,
                               int interval);
 
 /**
- * @brief Runs all benchmarks (JSON save/read and SQLite save/read) and prints results.
+ * @brief Compares size and scan speed of JSON records, BSON documents and Gorilla-compressed
+ * chunks.
+ *
+ * Stored measurements of every component are encoded both ways in memory, then fully decoded.
+ *
+ * @param components
+ *   List of component names to compare
+ */
+void benchmarkCompression(const std::vector<std::string>& components);
+
+/**
+ * @brief Runs all benchmarks (storage engine, BSON and SQLite save/read) and prints results.
  */
 void runBenchmark();
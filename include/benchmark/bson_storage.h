@@ -0,0 +1,81 @@
+#pragma once
+
+// Standard library headers
+#include <string>
+#include <vector>
+
+// Project headers
+#include "storage/measurement.h"
+
+/**
+ * @brief BSONStorageManager handles saving and loading temperature measurements as BSON documents.
+ *
+ * Only the benchmark uses it; measurements of the application are kept by the storage engine.
+ * Every component has its own "<Component>.bson" file in the benchmark directory holding a
+ * sequence of BSON documents with the keys of the JSON files ("Component", "Temperature",
+ * "Timestamp"). A document starts with its total size as a little-endian 32-bit integer, so
+ * readers skip records without decoding them.
+ */
+class BSONStorageManager {
+public:
+  /**
+   * @brief Constructs the manager storing its files in the given directory.
+   *
+   * @param directory
+   *   Directory holding the BSON files; if empty, defaults to the "benchmark" directory inside
+   *   getDataDirectory().
+   */
+  explicit BSONStorageManager(const std::string& directory = "");
+
+  /**
+   * @brief Appends a measurement record to the file of its component.
+   *
+   * @param m
+   *   Measurement containing component name, temperature, and timestamp.
+   *
+   * @throws std::runtime_error
+   *   If the file cannot be written.
+   */
+  void saveRecord(const Measurement& m);
+
+  /**
+   * @brief Retrieves the most recent measurement records for a given component.
+   *
+   * Document boundaries are found from the size prefixes; only the returned records are decoded.
+   * A document torn by a crash at the end of the file is ignored.
+   *
+   * @param component
+   *   Name of the hardware component (e.g., "CPU", "GPU", "Motherboard").
+   * @param limit
+   *   Maximum number of records to return, 0 or less for all records.
+   *
+   * @return std::vector<Measurement>
+   *   Vector of measurements sorted by ascending timestamp.
+   *
+   * @throws std::runtime_error
+   *   If the file cannot be read or a document is corrupted.
+   */
+  std::vector<Measurement> loadRecords(const std::string& component, int limit);
+
+  /**
+   * @brief Removes all BSON files and then the directory if it is left empty.
+   */
+  void clear();
+
+private:
+  /**
+   * @brief Gets path to the BSON file of a component.
+   *
+   * @param component
+   *   Name of the hardware component.
+   *
+   * @return std::string
+   *   Full path to the file.
+   */
+  std::string getPath(const std::string& component) const;
+
+  std::string directory;
+
+  static constexpr const char* BSON_EXTENSION = ".bson";
+  static constexpr const char* BENCHMARK_DIRECTORY = "benchmark";
+};
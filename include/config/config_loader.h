@@ -3,6 +3,7 @@
 
 // Standard library headers
 #include <fstream>
+#include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -33,6 +34,32 @@ public:
    */
   static std::string CHIP;
 
+  /**
+   * @brief Fsync policy of the write-ahead log ("always", "interval" or "os").
+   */
+  static std::string WAL_FSYNC;
+
+  /**
+   * @brief Time in milliseconds between write-ahead log fsyncs for the "interval" policy.
+   */
+  static int WAL_FSYNC_INTERVAL_MS;
+
+  /**
+   * @brief Retention policies by component name ("RETENTION_<Component>" keys); the empty name
+   * holds the default policy ("RETENTION" key).
+   */
+  static std::unordered_map<std::string, std::string> RETENTION;
+
+  /**
+   * @brief OHM endpoints to poll by host name ("OHM_HOST_<Name>" keys); empty to poll OHM_URL only.
+   */
+  static std::map<std::string, std::string> OHM_HOSTS;
+
+  /**
+   * @brief Time in milliseconds a collection waits for the OHM endpoints to answer.
+   */
+  static int OHM_TIMEOUT_MS;
+
   /**
    * @brief Loads configuration from file and sets component identifiers.
    *
@@ -69,15 +96,33 @@ public:
         else if (key == "CHIP") {
           CHIP = value;
         }
+        else if (key == "WAL_FSYNC") {
+          WAL_FSYNC = value;
+        }
+        else if (key == "WAL_FSYNC_INTERVAL_MS") {
+          WAL_FSYNC_INTERVAL_MS = std::stoi(value);
+        }
+        else if (key == "RETENTION") {
+          RETENTION[""] = value;
+        }
+        else if (key.rfind("RETENTION_", 0) == 0) {
+          RETENTION[key.substr(10)] = value;
+        }
+        else if (key == "OHM_TIMEOUT_MS") {
+          OHM_TIMEOUT_MS = std::stoi(value);
+        }
+        else if (key.rfind("OHM_HOST_", 0) == 0) {
+          OHM_HOSTS[key.substr(9)] = value;
+        }
       }
     }
   }
 
   /**
-   * @brief Validates that all required identifiers are present.
+   * @brief Validates that all required identifiers are present and options are valid.
    *
    * @throws std::runtime_error
-   *   If any required identifier is missing or empty
+   *   If any required identifier is missing or empty, or an option has an invalid value
    */
   static void validate();
 
@@ -2,6 +2,7 @@
 
 // Standard library headers
 #include <string>
+#include <vector>
 
 // Project headers
 #include "storage/measurement.h"
@@ -22,6 +23,20 @@ public:
    */
   virtual Measurement getMeasurement(const std::string& component) = 0;
 
+  /**
+   * @brief Retrieves measurements of several components taken at the same instant.
+   *
+   * @param components
+   *   Component names (e.g. "CPU", "GPU", "Motherboard")
+   * @param errors
+   *   Receives one message per component that could not be measured
+   *
+   * @return std::vector<Measurement>
+   *   Measurements of the remaining components, all sharing one timestamp
+   */
+  virtual std::vector<Measurement> getSnapshot(const std::vector<std::string>& components,
+                                               std::vector<std::string>& errors) = 0;
+
   /**
    * @brief Deletes measurement records for a specific component.
    *
@@ -1,13 +1,22 @@
 #pragma once
 
 // Standard library headers
+#include <cstdint>
 #include <vector>
 
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
 // Project headers
 #include "inputs/data_source.h"
+#include "storage/rollup_store.h"
 
 /**
- * @brief FileSource reads measurements from JSON files.
+ * @brief FileSource reads measurements from the storage engine and from the JSON files written by
+ * earlier versions.
+ *
+ * Legacy files are read in place and merged with the records of the engine by timestamp; they
+ * shrink as their records are deleted and are removed once empty.
  */
 class FileSource : public DataSource {
 public:
@@ -23,7 +32,21 @@ public:
   Measurement getMeasurement(const std::string& component) override;
 
   /**
-   * @brief Deletes measurement records from a JSON file.
+   * @brief Not implemented for FileSource.
+   *
+   * @param components std::vector<std::string>
+   *   Unused
+   * @param errors std::vector<std::string>
+   *   Unused
+   *
+   * @return std::vector<Measurement>
+   *   Always throws std::runtime_error
+   */
+  std::vector<Measurement> getSnapshot(const std::vector<std::string>& components,
+                                       std::vector<std::string>& errors) override;
+
+  /**
+   * @brief Deletes measurement records from the storage engine and legacy JSON files.
    *
    * @param component std::string
    *   Name of the component or "All components"
@@ -33,10 +56,26 @@ public:
    *   True = from beginning, False = from end
    *
    * @return void
-   *   Throws if file doesn't exist or JSON is invalid
+   *   Throws if no records are found
    */
   void deleteMeasurements(const std::string& component, int count, bool fromStart) override;
 
+  /**
+   * @brief Deletes measurement records older than a timestamp from the storage engine and legacy
+   * JSON files.
+   *
+   * Whole time partitions older than the timestamp are dropped without being read.
+   *
+   * @param component std::string
+   *   Name of the component or "All components"
+   * @param timestamp long long
+   *   Oldest timestamp to keep
+   *
+   * @return size_t
+   *   Number of deleted records
+   */
+  size_t deleteOlderThan(const std::string& component, long long timestamp);
+
   /**
    * @brief Exports measurement data to a CSV file.
    *
@@ -52,6 +91,42 @@ public:
    */
   void exportToCSV(const std::string& component, int count, bool fromStart);
 
+  /**
+   * @brief Exports measurements within a time range to a CSV file.
+   *
+   * @param component std::string
+   *   Name of the component or "All components"
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   *
+   * @return void
+   *   Throws on file I/O or JSON errors
+   */
+  void exportRangeToCSV(const std::string& component, long long from, long long to);
+
+  /**
+   * @brief Exports measurements within a time range whose temperature lies within [low, high] to
+   * a CSV file.
+   *
+   * @param component std::string
+   *   Name of the component or "All components"
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   * @param low double
+   *   Lowest matching temperature
+   * @param high double
+   *   Highest matching temperature
+   *
+   * @return void
+   *   Throws on file I/O errors
+   */
+  void exportTemperatureToCSV(const std::string& component, long long from, long long to,
+                              double low, double high);
+
   /**
    * @brief Returns a vector of measurements read from file.
    *
@@ -67,133 +142,302 @@ public:
    */
   std::vector<Measurement> getMeasurements(const std::string& component, int count, bool fromStart);
 
+  /**
+   * @brief Returns measurements with timestamps in the range [from, to).
+   *
+   * The range is found by binary search on the timestamp index and the storage engine seeks
+   * straight to it, so the cost follows the size of the result. A legacy file is streamed only
+   * until the records of the range the engine does not hold have been read.
+   *
+   * @param component std::string
+   *   Name of the hardware component or "all_measurements"
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   *
+   * @return std::vector<Measurement>
+   *   Measurements ordered by timestamp
+   */
+  std::vector<Measurement> getRange(const std::string& component, long long from, long long to);
+
+  /**
+   * @brief Deletes measurements with timestamps in the range [from, to).
+   *
+   * @param component std::string
+   *   Name of the component or "All components"
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   *
+   * @return size_t
+   *   Number of deleted records
+   */
+  size_t deleteRange(const std::string& component, long long from, long long to);
+
+  /**
+   * @brief Returns min/max/sum/count buckets of a component over a time range.
+   *
+   * Buckets come from the minute or hour rollups of the storage engine whenever step is a
+   * multiple of their width, so long ranges are served without reading the raw records. Records
+   * still held in legacy JSON files are not covered.
+   *
+   * @param component std::string
+   *   Name of the hardware component
+   * @param begin long long
+   *   First timestamp of the range
+   * @param end long long
+   *   Timestamp one past the range
+   * @param step long long
+   *   Width of the buckets in seconds
+   *
+   * @return std::vector<Rollup>
+   *   Non-empty buckets ordered by start
+   */
+  std::vector<Rollup> getRollups(const std::string& component, long long begin, long long end,
+                                 long long step);
+
+  /**
+   * @brief Returns measurements of a component within a time range whose temperature lies within
+   * [low, high], e.g. every reading above a threshold.
+   *
+   * Chunks of the storage engine whose temperature bounds cannot match are skipped without being
+   * decoded.
+   *
+   * @param component std::string
+   *   Name of the hardware component or "all_measurements"
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   * @param low double
+   *   Lowest matching temperature
+   * @param high double
+   *   Highest matching temperature
+   *
+   * @return std::vector<Measurement>
+   *   Matching measurements ordered by timestamp
+   */
+  std::vector<Measurement> findTemperature(const std::string& component, long long from,
+                                           long long to, double low, double high);
+
+  /**
+   * @brief Returns the names of all components stored by the storage engine or in legacy JSON
+   * files, including the "<Component>@<Host>" series of polled hosts.
+   *
+   * @return std::vector<std::string>
+   *   Component names in alphabetical order
+   */
+  std::vector<std::string> getComponents();
+
 private:
   /**
-   * @brief Deletes measurement records for all components.
+   * @brief Retrieves measurements of all components through a k-way merge ordered by timestamp.
    *
-   * @param count int
-   *   Number of records to delete (0 = all)
-   * @param fromStart bool
-   *   True = from beginning, False = from end
+   * @param count
+   *   Number of records to retrieve (0 for all).
+   * @param fromStart
+   *   If true, reads records from the beginning; otherwise, from the end.
+   *
+   * @return std::vector<Measurement>
+   *   List of measurement records.
+   *
+   * @throws std::runtime_error
+   */
+  std::vector<Measurement> getMergedMeasurements(int count, bool fromStart);
+
+  /**
+   * @brief Retrieves measurements of all components within a time range, merged by timestamp.
+   *
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   *
+   * @return std::vector<Measurement>
+   *   Measurements ordered by timestamp
    */
-  void deleteAllComponents(int count, bool fromStart);
+  std::vector<Measurement> getMergedRange(long long from, long long to);
 
   /**
-   * @brief Deletes measurement records for a single component.
+   * @brief Returns the oldest or newest measurements of a component from its legacy JSON file and
+   * the storage engine, merged by timestamp.
    *
    * @param component std::string
-   *   Name of the component
+   *   Name of the hardware component
    * @param count int
-   *   Number of records to delete (0 = all)
+   *   Number of records to return (0 = all)
    * @param fromStart bool
    *   True = from beginning, False = from end
+   * @param legacyCount size_t*
+   *   Receives how many of the returned records come from the legacy file, if not null
+   *
+   * @return std::vector<Measurement>
+   *   Measurements ordered by timestamp, empty if the component has none
    */
-  void deleteSingleComponent(const std::string& component, int count, bool fromStart);
+  std::vector<Measurement> readComponent(const std::string& component, int count, bool fromStart,
+                                         size_t* legacyCount = nullptr);
 
   /**
-   * @brief Extracts records to be deleted from a JSON array.
+   * @brief Returns measurements of a component within a time range from its legacy JSON file and
+   * the storage engine, merged by timestamp.
    *
-   * @param data nlohmann::json
-   *   JSON array of measurements
+   * @param component std::string
+   *   Name of the hardware component
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   *
+   * @return std::vector<Measurement>
+   *   Measurements ordered by timestamp, empty if the component has none
+   */
+  std::vector<Measurement> readComponentRange(const std::string& component, long long from,
+                                              long long to);
+
+  /**
+   * @brief Returns a vector of measurements streamed from a legacy JSON file.
+   *
+   * No DOM is built; reading from the start stops once count records have been taken and
+   * reading from the end scans the file backwards.
+   *
+   * @param component std::string
+   *   Name of the hardware component
    * @param count int
-   *   Number of records to extract
+   *   Number of records to return (0 = all)
    * @param fromStart bool
    *   True = from beginning, False = from end
    *
-   * @return std::vector<nlohmann::json>
-   *   Vector of records to be deleted
+   * @return std::vector<Measurement>
+   *   Measurements in file order, empty if the component has no legacy file
    */
-  std::vector<nlohmann::json> extractRecordsToDelete(nlohmann::json& data, int count,
-                                                     bool fromStart);
+  std::vector<Measurement> getLegacyMeasurements(const std::string& component, int count,
+                                                 bool fromStart);
 
   /**
-   * @brief Saves a JSON object to a file.
+   * @brief Returns measurements within a time range streamed from a legacy JSON file.
    *
-   * @param path std::string
-   *   File path
-   * @param data nlohmann::json
-   *   JSON data to write
+   * Legacy files were appended in timestamp order, so streaming stops at the first record past
+   * the range, or earlier once the expected number of records was read.
+   *
+   * @param component std::string
+   *   Name of the hardware component
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   * @param expected size_t
+   *   Number of records of the range the file holds at most
+   *
+   * @return std::vector<Measurement>
+   *   Measurements in file order, empty if the component has no legacy file
    */
-  void saveJsonToFile(const std::string& path, const nlohmann::json& data);
+  std::vector<Measurement> getLegacyRange(const std::string& component, long long from,
+                                          long long to, size_t expected = SIZE_MAX);
 
-private:
   /**
-   * @brief Deletes measurement records for all components.
+   * @brief Returns the names of the components that still have a legacy JSON file.
    *
-   * @param count int
-   *   Number of records to delete (0 = all)
-   * @param fromStart bool
-   *   True = from beginning, False = from end
+   * @return std::vector<std::string>
+   *   Component names in directory order
    */
-  void deleteFromAllComponents(int count, bool fromStart);
+  std::vector<std::string> getLegacyComponents();
 
   /**
-   * @brief Deletes measurement records for a single component.
+   * @brief Returns the path of the legacy JSON file of a component.
    *
    * @param component std::string
-   *   Name of the component
+   *   Name of the hardware component
+   *
+   * @return std::string
+   *   Path inside the data directory
+   */
+  std::string getLegacyPath(const std::string& component);
+
+  /**
+   * @brief Deletes the oldest or newest records of a legacy JSON file.
+   *
+   * @param component std::string
+   *   Name of the hardware component
    * @param count int
    *   Number of records to delete (0 = all)
    * @param fromStart bool
    *   True = from beginning, False = from end
+   *
+   * @return std::vector<long long>
+   *   Timestamps of the deleted records
    */
-  void deleteFromSingleComponent(const std::string& component, int count, bool fromStart);
+  std::vector<long long> deleteLegacyRecords(const std::string& component, int count,
+                                             bool fromStart);
 
   /**
-   * @brief Loads JSON data from a file.
+   * @brief Deletes the records of a legacy JSON file within a time range.
+   *
+   * @param component std::string
+   *   Name of the hardware component
+   * @param from long long
+   *   First timestamp of the range
+   * @param to long long
+   *   Timestamp one past the range
+   *
+   * @return std::vector<long long>
+   *   Timestamps of the deleted records
+   */
+  std::vector<long long> deleteLegacyRange(const std::string& component, long long from,
+                                           long long to);
+
+  /**
+   * @brief Loads the JSON array of a legacy file.
    *
    * @param path std::string
-   *   File path to load.
+   *   Path to the file
    *
    * @return nlohmann::json
-   *   Loaded JSON data.
-   *
-   * @throws std::runtime_error
+   *   Array of records
    */
   nlohmann::json loadJsonFromFile(const std::string& path);
 
   /**
-   * @brief Extracts records to be deleted from a JSON array.
+   * @brief Saves the JSON array of a legacy file, removing the file once it is empty.
    *
+   * @param path std::string
+   *   Path to the file
    * @param data nlohmann::json
-   *   JSON array of measurements.
-   * @param count int
-   *   Number of records to extract.
-   * @param fromStart bool
-   *   True = from beginning, False = from end.
-   *
-   * @return std::vector<nlohmann::json>
-   *   Vector of extracted records.
+   *   Array of records
    */
-  std::vector<nlohmann::json> extractDeletedRecords(nlohmann::json& data, int count,
-                                                    bool fromStart);
+  void saveJsonToFile(const std::string& path, const nlohmann::json& data);
 
   /**
-   * @brief Extracts timestamps from a list of JSON records.
-   *
-   * @param records std::vector<nlohmann::json>
-   *   List of JSON records.
+   * @brief Writes measurements to the CSV export file of a component.
    *
-   * @return std::vector<long long>
-   *   List of extracted timestamps.
+   * @param component std::string
+   *   Name of the component or "All components"
+   * @param measurements std::vector<Measurement>
+   *   Measurements to write
    */
-  std::vector<long long> extractTimestamps(const std::vector<nlohmann::json>& records);
+  void writeCSV(const std::string& component, const std::vector<Measurement>& measurements);
 
   /**
-   * @brief Updates a component file by removing specified timestamps.
+   * @brief Deletes measurement records for all components.
    *
-   * @param component std::string
-   *   Name of the component.
-   * @param timestamps std::vector<long long>
-   *   Timestamps to remove.
+   * @param count int
+   *   Number of records to delete (0 = all)
+   * @param fromStart bool
+   *   True = from beginning, False = from end
    */
-  void updateComponentFile(const std::string& component, const std::vector<long long>& timestamps);
+  void deleteFromAllComponents(int count, bool fromStart);
 
   /**
-   * @brief Updates all_measurements.json file by removing specified timestamps.
+   * @brief Deletes measurement records for a single component from its legacy JSON file and the
+   * storage engine.
    *
-   * @param timestamps std::vector<long long>
-   *   Timestamps to remove.
+   * @param component std::string
+   *   Name of the component
+   * @param count int
+   *   Number of records to delete (0 = all)
+   * @param fromStart bool
+   *   True = from beginning, False = from end
    */
-  void updateAllMeasurementsFile(const std::vector<long long>& timestamps);
+  void deleteFromSingleComponent(const std::string& component, int count, bool fromStart);
 };
@@ -0,0 +1,209 @@
+#pragma once
+
+// Standard library headers
+#include <functional>
+#include <istream>
+#include <string>
+
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
+// Project headers
+#include "storage/measurement.h"
+
+/**
+ * @brief Streams measurements out of a legacy JSON array without building a DOM.
+ *
+ * Every object of the top-level array is turned into a Measurement and handed to a callback as
+ * soon as it is closed, so memory use does not depend on the size of the file. Objects missing
+ * any of the "Component", "Temperature" and "Timestamp" fields are skipped.
+ */
+class JsonStreamReader : public nlohmann::json_sax<nlohmann::json> {
+public:
+  /**
+   * @brief Callback receiving parsed records; returning false stops parsing.
+   */
+  using Callback = std::function<bool(const Measurement&)>;
+
+  /**
+   * @brief Creates a reader passing records to a callback.
+   *
+   * @param onRecord
+   *   Called for every parsed record
+   */
+  explicit JsonStreamReader(Callback onRecord);
+
+  /**
+   * @brief Parses a stream until its end or until the callback asks to stop.
+   *
+   * @param input
+   *   Stream holding a JSON array of records
+   *
+   * @throws std::runtime_error
+   *   If the JSON is malformed before parsing was stopped
+   */
+  void parse(std::istream& input);
+
+  /**
+   * @brief Handles a null value.
+   *
+   * @return bool
+   *   Always true
+   */
+  bool null() override;
+
+  /**
+   * @brief Handles a boolean value.
+   *
+   * @param val
+   *   Parsed value
+   *
+   * @return bool
+   *   Always true
+   */
+  bool boolean(bool val) override;
+
+  /**
+   * @brief Handles a signed integer, stored if it belongs to a record field.
+   *
+   * @param val
+   *   Parsed value
+   *
+   * @return bool
+   *   Always true
+   */
+  bool number_integer(number_integer_t val) override;
+
+  /**
+   * @brief Handles an unsigned integer, stored if it belongs to a record field.
+   *
+   * @param val
+   *   Parsed value
+   *
+   * @return bool
+   *   Always true
+   */
+  bool number_unsigned(number_unsigned_t val) override;
+
+  /**
+   * @brief Handles a floating-point number, stored if it belongs to a record field.
+   *
+   * @param val
+   *   Parsed value
+   * @param s
+   *   Number as written in the input
+   *
+   * @return bool
+   *   Always true
+   */
+  bool number_float(number_float_t val, const string_t& s) override;
+
+  /**
+   * @brief Handles a string, stored if it is the component of a record.
+   *
+   * @param val
+   *   Parsed value
+   *
+   * @return bool
+   *   Always true
+   */
+  bool string(string_t& val) override;
+
+  /**
+   * @brief Handles a binary value.
+   *
+   * @param val
+   *   Parsed value
+   *
+   * @return bool
+   *   Always true
+   */
+  bool binary(binary_t& val) override;
+
+  /**
+   * @brief Handles the start of an object; objects of the top-level array start a record.
+   *
+   * @param elements
+   *   Number of elements if known
+   *
+   * @return bool
+   *   Always true
+   */
+  bool start_object(std::size_t elements) override;
+
+  /**
+   * @brief Handles an object key.
+   *
+   * @param val
+   *   Parsed key
+   *
+   * @return bool
+   *   Always true
+   */
+  bool key(string_t& val) override;
+
+  /**
+   * @brief Handles the end of an object, passing a complete record to the callback.
+   *
+   * @return bool
+   *   False if the callback asked to stop
+   */
+  bool end_object() override;
+
+  /**
+   * @brief Handles the start of an array.
+   *
+   * @param elements
+   *   Number of elements if known
+   *
+   * @return bool
+   *   Always true
+   */
+  bool start_array(std::size_t elements) override;
+
+  /**
+   * @brief Handles the end of an array.
+   *
+   * @return bool
+   *   Always true
+   */
+  bool end_array() override;
+
+  /**
+   * @brief Handles a parse error.
+   *
+   * @param position
+   *   Position of the error in the input
+   * @param last_token
+   *   Last read token
+   * @param ex
+   *   Exception describing the error
+   *
+   * @return bool
+   *   Always false
+   */
+  bool parse_error(std::size_t position, const std::string& last_token,
+                   const nlohmann::detail::exception& ex) override;
+
+private:
+  /**
+   * @brief Checks whether the parser is directly inside a record object.
+   *
+   * @return bool
+   *   True for values of record fields
+   */
+  bool inRecord() const;
+
+  Callback onRecord;
+  int depth;
+  std::string currentKey;
+  Measurement current;
+  int fields;
+  bool stopped;
+  std::string error;
+
+  static constexpr int COMPONENT_FIELD = 1;
+  static constexpr int TEMPERATURE_FIELD = 2;
+  static constexpr int TIMESTAMP_FIELD = 4;
+  static constexpr int ALL_FIELDS = COMPONENT_FIELD | TEMPERATURE_FIELD | TIMESTAMP_FIELD;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+// Standard library headers
+#include <string>
+#include <vector>
+
+// Project headers
+#include "storage/measurement.h"
+
+/**
+ * @brief Reads the newest records of a legacy JSON array by scanning the file backwards.
+ *
+ * Legacy records are flat objects, so the closing brace of a record and the nearest opening
+ * brace before it delimit one record. The file is read in blocks from its end until enough
+ * records are found, which makes the cost independent of the length of the history.
+ */
+class JsonTailReader {
+public:
+  /**
+   * @brief Creates a reader for a JSON file.
+   *
+   * @param path
+   *   Path to the file
+   */
+  explicit JsonTailReader(const std::string& path);
+
+  /**
+   * @brief Reads the last records of the file.
+   *
+   * @param count
+   *   Number of records to read
+   *
+   * @return std::vector<Measurement>
+   *   Up to count records, oldest first
+   *
+   * @throws std::runtime_error
+   *   If the file cannot be opened or a record cannot be parsed
+   */
+  std::vector<Measurement> readLast(size_t count) const;
+
+private:
+  std::string path;
+
+  static constexpr size_t BLOCK_SIZE = 64 * 1024;
+};
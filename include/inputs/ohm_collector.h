@@ -0,0 +1,141 @@
+#pragma once
+
+// Standard library headers
+#include <map>
+#include <string>
+#include <vector>
+
+// Third-party libraries
+#include <curl/curl.h>
+
+// Project headers
+#include "api/ohm_data.h"
+#include "inputs/data_source.h"
+
+/**
+ * @brief OHMCollector polls the Open Hardware Monitor endpoints of several machines concurrently.
+ *
+ * Every host keeps its own cURL handle, connection and response buffer, and all of them are driven
+ * by one cURL multi handle. A snapshot starts a request to every idle host and then handles the
+ * responses in the order they arrive, until all hosts have answered or the timeout has passed. A
+ * host that has not answered by then keeps its request in flight instead of delaying the
+ * snapshot; its response is collected by a later snapshot, and no new request is sent to it
+ * meanwhile.
+ *
+ * Measurements are tagged with their host by naming their series "<Component>@<Host>".
+ *
+ * The collector is not synchronized; the caller serializes access.
+ */
+class OHMCollector : public DataSource {
+public:
+  /**
+   * @brief Separator between the component and the host in the name of a series.
+   */
+  static constexpr char HOST_SEPARATOR = '@';
+
+  /**
+   * @brief Creates a handle for every host.
+   *
+   * @param hosts std::map<std::string, std::string>
+   *   URLs of the data.json endpoints by host name
+   * @param timeoutMs int
+   *   Time in milliseconds a snapshot waits for the hosts to answer
+   *
+   * @throws std::runtime_error
+   *   If a cURL handle cannot be created
+   */
+  OHMCollector(const std::map<std::string, std::string>& hosts, int timeoutMs);
+
+  /**
+   * @brief Aborts the requests in flight and releases the handles.
+   */
+  ~OHMCollector() override;
+
+  OHMCollector(const OHMCollector&) = delete;
+  OHMCollector& operator=(const OHMCollector&) = delete;
+
+  /**
+   * @brief Not implemented for OHMCollector.
+   *
+   * @param component std::string
+   *   Unused
+   *
+   * @return Measurement
+   *   Always throws std::runtime_error
+   */
+  Measurement getMeasurement(const std::string& component) override;
+
+  /**
+   * @brief Retrieves temperatures of several components from every host.
+   *
+   * @param components std::vector<std::string>
+   *   Names of the hardware components
+   * @param errors std::vector<std::string>
+   *   Receives one message per host or host series that could not be measured
+   *
+   * @return std::vector<Measurement>
+   *   Measurements of the hosts that answered, named "<Component>@<Host>"; those of one host share
+   *   the timestamp of its document
+   */
+  std::vector<Measurement> getSnapshot(const std::vector<std::string>& components,
+                                       std::vector<std::string>& errors) override;
+
+  /**
+   * @brief Not supported for OHMCollector.
+   *
+   * @param component std::string
+   *   Unused
+   * @param count int
+   *   Unused
+   * @param fromStart bool
+   *   Unused
+   *
+   * @return void
+   *   Always throws std::runtime_error
+   */
+  void deleteMeasurements(const std::string& component, int count, bool fromStart) override;
+
+private:
+  /**
+   * @brief Endpoint of one host.
+   */
+  struct Host {
+    std::string name;
+    std::string url;
+    CURL* curl;
+    std::string response;
+    bool pending;
+    SensorPaths paths;
+  };
+
+  /**
+   * @brief Handles a finished request of a host.
+   *
+   * @param host
+   *   Host whose request finished
+   * @param result
+   *   Outcome of the transfer
+   * @param components
+   *   Names of the hardware components to read
+   * @param measurements
+   *   Receives the measurements of the host
+   * @param errors
+   *   Receives one message per failure
+   */
+  void readResponse(Host& host, CURLcode result, const std::vector<std::string>& components,
+                    std::vector<Measurement>& measurements, std::vector<std::string>& errors);
+
+  /**
+   * @brief Time in milliseconds after which a request still in flight is aborted.
+   */
+  static constexpr long REQUEST_TIMEOUT_MS = 30000;
+
+  /**
+   * @brief Initial capacity of every response buffer, in bytes.
+   */
+  static constexpr size_t RESPONSE_RESERVE = 64 * 1024;
+
+  std::vector<Host> hosts;
+  CURLM* multi;
+  int timeoutMs;
+};
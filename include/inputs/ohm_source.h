@@ -1,6 +1,7 @@
 #pragma once
 
 // Project headers
+#include "api/ohm_data.h"
 #include "inputs/data_source.h"
 
 /**
@@ -19,6 +20,23 @@ public:
    */
   Measurement getMeasurement(const std::string& component) override;
 
+  /**
+   * @brief Retrieves temperatures of several components from a single OHM document.
+   *
+   * @param components std::vector<std::string>
+   *   Names of the hardware components
+   * @param errors std::vector<std::string>
+   *   Receives one message per component without a temperature
+   *
+   * @return std::vector<Measurement>
+   *   Measurements sharing the timestamp of the document
+   *
+   * @throws std::runtime_error
+   *   If the document cannot be fetched or parsed
+   */
+  std::vector<Measurement> getSnapshot(const std::vector<std::string>& components,
+                                       std::vector<std::string>& errors) override;
+
   /**
    * @brief Not supported for OHMSource.
    *
@@ -33,4 +51,33 @@ public:
    *   Always throws std::runtime_error
    */
   void deleteMeasurements(const std::string& component, int count, bool fromStart) override;
+
+  /**
+   * @brief Reads the temperature of a component from an OHM document.
+   *
+   * @param ohm OHMData
+   *   Sensor readings
+   * @param component std::string
+   *   Name of the hardware component
+   *
+   * @return double
+   *   Temperature in Celsius
+   *
+   * @throws std::runtime_error
+   * @throws std::invalid_argument
+   */
+  static double readTemperature(const OHMData& ohm, const std::string& component);
+
+private:
+  /**
+   * @brief Fetches and parses the current OHM document.
+   *
+   * @return OHMData
+   *   Sensor readings stamped with the time of the fetch
+   *
+   * @throws std::runtime_error
+   */
+  OHMData fetchSnapshot();
+
+  SensorPaths paths; ///< Sensor paths resolved in earlier snapshots.
 };
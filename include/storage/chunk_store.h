@@ -0,0 +1,534 @@
+#pragma once
+
+// Standard library headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Project headers
+#include "storage/mapped_file.h"
+#include "storage/measurement.h"
+
+/**
+ * @brief Header preceding every compressed chunk.
+ */
+struct ChunkHeader {
+  /**
+   * @brief Chunk signature, always "HCHK".
+   */
+  char magic[4];
+
+  /**
+   * @brief Number of measurements in the chunk.
+   */
+  uint32_t count;
+
+  /**
+   * @brief Timestamp of the first measurement.
+   */
+  int64_t firstTimestamp;
+
+  /**
+   * @brief Timestamp of the last measurement.
+   */
+  int64_t lastTimestamp;
+
+  /**
+   * @brief Size of the Gorilla-encoded payload in bytes.
+   */
+  uint32_t payloadSize;
+
+  /**
+   * @brief CRC-32 of the payload.
+   */
+  uint32_t checksum;
+};
+
+static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader must be 32 bytes");
+
+/**
+ * @brief Zone map entry of one chunk, as stored in the zone file of a chunk file.
+ */
+struct ChunkZone {
+  /**
+   * @brief Byte offset of the chunk header within the chunk file.
+   */
+  uint64_t offset;
+
+  /**
+   * @brief CRC-32 of the chunk payload, which ties the entry to the chunk it describes.
+   */
+  uint32_t checksum;
+
+  /**
+   * @brief Reserved, always 0.
+   */
+  uint32_t reserved;
+
+  /**
+   * @brief Lowest temperature of the chunk.
+   */
+  double minTemperature;
+
+  /**
+   * @brief Highest temperature of the chunk.
+   */
+  double maxTemperature;
+};
+
+static_assert(sizeof(ChunkZone) == 32, "ChunkZone must be 32 bytes");
+
+/**
+ * @brief Entry of the sparse index of a chunk file, locating one chunk.
+ */
+struct ChunkIndexEntry {
+  /**
+   * @brief Timestamp of the first measurement of the chunk.
+   */
+  int64_t firstTimestamp;
+
+  /**
+   * @brief Timestamp of the last measurement of the chunk.
+   */
+  int64_t lastTimestamp;
+
+  /**
+   * @brief Position of the first measurement of the chunk within the file.
+   */
+  size_t position;
+
+  /**
+   * @brief Byte offset of the chunk header within the file.
+   */
+  size_t offset;
+
+  /**
+   * @brief Lowest temperature of the chunk, meaningful only if zoned.
+   */
+  double minTemperature;
+
+  /**
+   * @brief Highest temperature of the chunk, meaningful only if zoned.
+   */
+  double maxTemperature;
+
+  /**
+   * @brief Whether the zone file holds the temperature bounds of the chunk.
+   */
+  bool zoned;
+};
+
+/**
+ * @brief Stores sealed measurements of a component as Gorilla-compressed chunks.
+ *
+ * The compacted history of a component is split into time partitions, each stored in its own
+ * "<Component>/<partition>.chunks" file, where partition is the first timestamp it covers. Older
+ * versions kept the whole history in a single "<Component>.chunks" file, which a store created
+ * without a partition addresses. A chunk is laid out
+ * as a ChunkHeader, the encoded payload and a 32-bit trailer holding the total chunk size, which
+ * lets readers walk the file backwards as well as forwards.
+ *
+ * Every chunk file has a sparse index mapping the timestamps of its chunks, i.e. of every
+ * CHUNK_RECORDS-th measurement, to their byte offsets. It is built from the chunk headers on the
+ * first time-range read, kept in memory and dropped whenever the store changes the file.
+ *
+ * Next to every chunk file, a "<partition>.zones" file holds the lowest and highest temperature of
+ * each chunk as ChunkZone entries, so temperature predicates skip chunks that cannot match. The
+ * zone file is derived data: an entry only counts if the offset and checksum of its chunk match,
+ * so a stale or missing zone file never hides records, it only disables skipping.
+ */
+class ChunkStore {
+public:
+  /**
+   * @brief Maximum number of measurements encoded in a single chunk.
+   */
+  static constexpr size_t CHUNK_RECORDS = 1024;
+
+  /**
+   * @brief Creates a store addressing the unpartitioned chunk files of older versions.
+   */
+  ChunkStore();
+
+  /**
+   * @brief Creates a store addressing one time partition of every component.
+   *
+   * @param partition
+   *   First timestamp covered by the partition
+   */
+  explicit ChunkStore(int64_t partition);
+
+  /**
+   * @brief Encodes measurements and appends them as new chunks, then syncs the file.
+   *
+   * @param series
+   *   Name of the component
+   * @param records
+   *   Measurements ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If the chunk file cannot be written
+   */
+  void append(const std::string& series, const std::vector<Measurement>& records);
+
+  /**
+   * @brief Atomically replaces all chunks of the component.
+   *
+   * @param series
+   *   Name of the component
+   * @param records
+   *   Measurements ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If the chunk file cannot be written
+   */
+  void replace(const std::string& series, const std::vector<Measurement>& records);
+
+  /**
+   * @brief Writes and syncs a replacement of the chunk file next to it without installing it.
+   *
+   * Together with commitStaged() this lets the caller record the new size of the file in between,
+   * so a crash leaves either the old or the new file in place.
+   *
+   * @param series
+   *   Name of the component
+   * @param records
+   *   Measurements ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If the staged file cannot be written
+   */
+  void stage(const std::string& series, const std::vector<Measurement>& records);
+
+  /**
+   * @brief Installs the staged replacement of the chunk file.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @throws std::runtime_error
+   *   If the staged file cannot be renamed
+   */
+  void commitStaged(const std::string& series);
+
+  /**
+   * @brief Finishes or discards a replacement interrupted by a crash.
+   *
+   * The staged file is installed if it holds the expected number of measurements and removed
+   * otherwise.
+   *
+   * @param series
+   *   Name of the component
+   * @param expected
+   *   Number of measurements the chunk file is known to hold
+   *
+   * @throws std::runtime_error
+   *   If the staged file cannot be renamed
+   */
+  void recoverStaged(const std::string& series, size_t expected);
+
+  /**
+   * @brief Gets number of measurements stored in complete chunks.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return size_t
+   *   Number of measurements, 0 if the component has no chunks
+   */
+  size_t count(const std::string& series) const;
+
+  /**
+   * @brief Decodes measurements in the range [begin, end), one chunk at a time.
+   *
+   * The file is memory-mapped and payloads are decoded in place; chunks entirely outside the
+   * range are skipped without being read.
+   *
+   * @param series
+   *   Name of the component
+   * @param begin
+   *   Position of the first measurement to read
+   * @param end
+   *   Position one past the last measurement to read
+   * @param out
+   *   Vector receiving the measurements
+   *
+   * @throws std::runtime_error
+   *   If a chunk is corrupted
+   */
+  void read(const std::string& series, size_t begin, size_t end,
+            std::vector<Measurement>& out) const;
+
+  /**
+   * @brief Decodes measurements with timestamps in the range [begin, end).
+   *
+   * The chunks covering the range are found by binary search in the sparse index of the file and
+   * only they are decoded, so the cost depends on the width of the range rather than the size of
+   * the file.
+   *
+   * @param series
+   *   Name of the component
+   * @param count
+   *   Number of measurements the file is known to hold; later ones are ignored
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   * @param out
+   *   Vector receiving the measurements, ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If a chunk is corrupted
+   */
+  void readRange(const std::string& series, size_t count, int64_t begin, int64_t end,
+                 std::vector<Measurement>& out) const;
+
+  /**
+   * @brief Decodes measurements with timestamps in the range [begin, end) from the chunks whose
+   * zone may hold temperatures within [low, high].
+   *
+   * Chunks are located like in readRange(); those whose zone lies entirely outside [low, high]
+   * are skipped without being decoded, unless they share a timestamp with a neighbouring chunk.
+   * Temperatures are not filtered per measurement.
+   *
+   * @param series
+   *   Name of the component
+   * @param count
+   *   Number of measurements the file is known to hold; later ones are ignored
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   * @param low
+   *   Lowest matching temperature
+   * @param high
+   *   Highest matching temperature
+   * @param out
+   *   Vector receiving the measurements, ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If a chunk is corrupted
+   */
+  void readMatching(const std::string& series, size_t count, int64_t begin, int64_t end,
+                    double low, double high, std::vector<Measurement>& out) const;
+
+  /**
+   * @brief Writes the zone file of a chunk file whose chunks are not all covered by it.
+   *
+   * Only the chunks missing from the zone file are decoded, so chunk files written by older
+   * versions are decoded once.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @throws std::runtime_error
+   *   If a chunk is corrupted or the zone file cannot be written
+   */
+  void buildZones(const std::string& series);
+
+  /**
+   * @brief Decodes the last measurements by walking chunks backwards from the end of the file.
+   *
+   * Only the chunks holding the requested measurements are visited, so the cost does not depend
+   * on the length of the history.
+   *
+   * @param series
+   *   Name of the component
+   * @param count
+   *   Number of measurements to read
+   * @param out
+   *   Vector receiving the measurements, oldest first
+   *
+   * @return bool
+   *   False if the file cannot be walked backwards, e.g. after a torn write; out is then unchanged
+   *
+   * @throws std::runtime_error
+   *   If a chunk is corrupted
+   */
+  bool readLast(const std::string& series, size_t count, std::vector<Measurement>& out) const;
+
+  /**
+   * @brief Drops chunks past the given number of measurements.
+   *
+   * @param series
+   *   Name of the component
+   * @param count
+   *   Number of measurements to keep; chunks are dropped whole
+   *
+   * @throws std::runtime_error
+   *   If the chunk file cannot be truncated
+   */
+  void truncate(const std::string& series, size_t count);
+
+  /**
+   * @brief Removes the chunk file of the component.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @throws std::runtime_error
+   *   If the file exists and cannot be removed
+   */
+  void remove(const std::string& series);
+
+  /**
+   * @brief Gets time partitions of a component that have a chunk file or a staged replacement.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return std::vector<int64_t>
+   *   First timestamps of the partitions, in ascending order
+   */
+  static std::vector<int64_t> listPartitions(const std::string& series);
+
+  /**
+   * @brief Gets path to the directory holding the partitions of a component.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return std::string
+   *   Full path to the partition directory
+   */
+  static std::string getPartitionDirectory(const std::string& series);
+
+  /**
+   * @brief Gets path to the chunk file of a component.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return std::string
+   *   Full path to the chunk file
+   */
+  std::string getChunkPath(const std::string& series) const;
+
+  /**
+   * @brief Gets path to the zone file of a component.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return std::string
+   *   Full path to the zone file
+   */
+  std::string getZonePath(const std::string& series) const;
+
+  /**
+   * @brief Gets path to the staged replacement of the chunk file of a component.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return std::string
+   *   Full path to the staged file
+   */
+  std::string getStagedPath(const std::string& series) const;
+
+  /**
+   * @brief Encodes measurements into chunks of at most CHUNK_RECORDS measurements.
+   *
+   * @param records
+   *   Measurements ordered by timestamp
+   *
+   * @return std::string
+   *   Bytes of the encoded chunks
+   */
+  static std::string encode(const std::vector<Measurement>& records);
+
+private:
+  /**
+   * @brief Builds the zone entries of chunks produced by encode().
+   *
+   * @param records
+   *   Measurements passed to encode()
+   * @param chunks
+   *   Bytes returned by encode()
+   * @param base
+   *   Offset the chunks are written at
+   *
+   * @return std::string
+   *   Bytes of the zone entries, one per chunk
+   */
+  static std::string encodeZones(const std::vector<Measurement>& records,
+                                 const std::string& chunks, size_t base);
+
+  /**
+   * @brief Reads the zone file of a chunk file.
+   *
+   * @param path
+   *   Path to the zone file
+   *
+   * @return std::unordered_map<uint64_t, ChunkZone>
+   *   Zone entries by chunk offset, later entries replacing earlier ones
+   */
+  static std::unordered_map<uint64_t, ChunkZone> loadZones(const std::string& path);
+
+  /**
+   * @brief Gets number of measurements stored in complete chunks of a file.
+   *
+   * @param path
+   *   Path to the chunk file
+   *
+   * @return size_t
+   *   Number of measurements, 0 if the file does not exist
+   */
+  size_t countFile(const std::string& path) const;
+
+  /**
+   * @brief Reads the chunk header at an offset and checks the chunk lies entirely within the
+   * file.
+   *
+   * @param file
+   *   Mapped chunk file
+   * @param offset
+   *   Offset of a chunk boundary
+   * @param header
+   *   Receives the chunk header
+   *
+   * @return bool
+   *   False at the end of the file or at a torn or invalid chunk
+   */
+  bool nextChunk(const MappedFile& file, size_t offset, ChunkHeader& header) const;
+
+  /**
+   * @brief Gets the sparse index of a chunk file, building it if the file changed since.
+   *
+   * @param path
+   *   Path to the chunk file
+   * @param file
+   *   Mapping of the chunk file
+   *
+   * @return std::shared_ptr<const std::vector<ChunkIndexEntry>>
+   *   One entry per complete chunk, ordered by offset
+   */
+  std::shared_ptr<const std::vector<ChunkIndexEntry>> getIndex(const std::string& path,
+                                                               const MappedFile& file) const;
+
+  /**
+   * @brief Drops the cached sparse index of a chunk file.
+   *
+   * @param path
+   *   Path to the chunk file
+   */
+  static void forgetIndex(const std::string& path);
+
+  /**
+   * @brief Gets size of a whole chunk including its header and trailer.
+   *
+   * @param header
+   *   Header of the chunk
+   *
+   * @return size_t
+   *   Size in bytes
+   */
+  static size_t chunkSize(const ChunkHeader& header);
+
+  bool partitioned;
+  int64_t partition;
+
+  static constexpr const char* CHUNK_EXTENSION = ".chunks";
+  static constexpr const char* ZONE_EXTENSION = ".zones";
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+// Standard library headers
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Writes individual bits into a growing byte buffer, most significant bit first.
+ */
+class BitWriter {
+public:
+  /**
+   * @brief Creates an empty writer.
+   */
+  BitWriter();
+
+  /**
+   * @brief Writes a single bit.
+   *
+   * @param bit
+   *   Bit to write
+   */
+  void writeBit(bool bit);
+
+  /**
+   * @brief Writes the lowest bits of a value.
+   *
+   * @param value
+   *   Value whose bits are written
+   * @param count
+   *   Number of bits to write (0-64), most significant first
+   */
+  void writeBits(uint64_t value, int count);
+
+  /**
+   * @brief Gets the written bytes, the last byte padded with zero bits.
+   *
+   * @return const std::string&
+   *   Encoded bytes
+   */
+  const std::string& getBytes() const;
+
+private:
+  std::string bytes;
+  int freeBits;
+};
+
+/**
+ * @brief Reads individual bits from a byte buffer, most significant bit first.
+ */
+class BitReader {
+public:
+  /**
+   * @brief Creates a reader over an existing buffer; the buffer is not copied.
+   *
+   * @param data
+   *   Pointer to the first byte
+   * @param size
+   *   Number of bytes
+   */
+  BitReader(const char* data, size_t size);
+
+  /**
+   * @brief Reads a single bit.
+   *
+   * @return bool
+   *   Bit value
+   *
+   * @throws std::runtime_error
+   *   If the buffer is exhausted
+   */
+  bool readBit();
+
+  /**
+   * @brief Reads a value stored on a number of bits.
+   *
+   * @param count
+   *   Number of bits to read (0-64)
+   *
+   * @return uint64_t
+   *   Value made of the read bits
+   *
+   * @throws std::runtime_error
+   *   If the buffer is exhausted
+   */
+  uint64_t readBits(int count);
+
+private:
+  const uint8_t* data;
+  size_t size;
+  size_t position;
+};
+
+/**
+ * @brief Compresses a series of samples as in Facebook's Gorilla paper.
+ *
+ * Timestamps are stored as delta-of-delta with variable-length prefixes, temperatures as the
+ * XOR with the previous value where only the meaningful bits are written. Regularly sampled,
+ * slowly changing readings take one or two bytes per sample.
+ */
+class GorillaEncoder {
+public:
+  /**
+   * @brief Creates an empty encoder.
+   */
+  GorillaEncoder();
+
+  /**
+   * @brief Appends a sample.
+   *
+   * @param timestamp
+   *   Timestamp of the sample
+   * @param value
+   *   Value of the sample
+   */
+  void append(int64_t timestamp, double value);
+
+  /**
+   * @brief Gets number of appended samples.
+   *
+   * @return uint32_t
+   *   Number of samples
+   */
+  uint32_t getCount() const;
+
+  /**
+   * @brief Gets the encoded samples.
+   *
+   * @return const std::string&
+   *   Encoded bytes
+   */
+  const std::string& getBytes() const;
+
+private:
+  BitWriter writer;
+  uint32_t count;
+  int64_t prevTimestamp;
+  int64_t prevDelta;
+  uint64_t prevValue;
+  int prevLeading;
+  int prevTrailing;
+};
+
+/**
+ * @brief Decodes samples written by GorillaEncoder one at a time.
+ */
+class GorillaDecoder {
+public:
+  /**
+   * @brief Creates a decoder over encoded bytes; the bytes are not copied.
+   *
+   * @param data
+   *   Pointer to the encoded bytes
+   * @param size
+   *   Number of encoded bytes
+   * @param count
+   *   Number of samples stored in the bytes
+   */
+  GorillaDecoder(const char* data, size_t size, uint32_t count);
+
+  /**
+   * @brief Decodes the next sample.
+   *
+   * @param timestamp
+   *   Receives timestamp of the sample
+   * @param value
+   *   Receives value of the sample
+   *
+   * @return bool
+   *   False when all samples have been decoded
+   *
+   * @throws std::runtime_error
+   *   If the encoded bytes are truncated
+   */
+  bool next(int64_t& timestamp, double& value);
+
+private:
+  BitReader reader;
+  uint32_t remaining;
+  uint32_t decoded;
+  int64_t prevTimestamp;
+  int64_t prevDelta;
+  uint64_t prevValue;
+  int prevLeading;
+  int prevTrailing;
+};
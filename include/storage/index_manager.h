@@ -1,6 +1,10 @@
 #pragma once
 
 // Standard library headers
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -8,11 +12,54 @@
 // Third-party library headers
 #include <nlohmann/json.hpp>
 
+// Project headers
+#include "storage/mapped_file.h"
+
 /**
  * @brief Manages indexing of temperature measurements by component and timestamp.
+ *
+ * Changes are appended to a journal ("index.journal" in the data directory), one line per
+ * change; the whole index is written to the binary snapshot "index.bin" only as a checkpoint once
+ * the journal holds JOURNAL_ENTRIES changes. Both carry a generation number, so a journal older
+ * than the checkpoint is not replayed twice.
+ *
+ * The snapshot is a file header followed, for every component, by a component header, its name
+ * and a contiguous array of int64 timestamps. It is memory-mapped on startup and a component is
+ * copied out of the mapping only when it is first used, so startup does not depend on the size of
+ * the history. Installs that still have "index.json" are migrated to the snapshot on startup.
+ *
+ * All methods may be called from any thread. Writers serialize on the mutex and publish the
+ * timestamps of every component as an immutable map swapped in atomically; readers load the map
+ * without locking and take a snapshot, a reference-counted view of the timestamps of a component.
+ * Timestamps not older than the newest one are appended in place behind the end of the published
+ * views; every other change works on a copy, so a snapshot never changes once taken. Components
+ * still in the mapped snapshot file are viewed in the mapping.
+ *
+ * Journal lines are buffered and flushed at checkpoints and when the storage engine writes its
+ * memtables as runs, the point from which it no longer replays their records on recovery.
  */
 class IndexManager {
 public:
+  /**
+   * @brief Immutable sorted timestamps of a component shared with readers.
+   */
+  struct Snapshot {
+    /**
+     * @brief Keeps the timestamps alive: a vector of the index or the mapped snapshot file.
+     */
+    std::shared_ptr<const void> owner;
+
+    /**
+     * @brief First timestamp.
+     */
+    const long long* data = nullptr;
+
+    /**
+     * @brief Number of timestamps.
+     */
+    size_t count = 0;
+  };
+
   /**
    * @brief Gets singleton instance of IndexManager.
    *
@@ -21,9 +68,17 @@ public:
    */
   static IndexManager& getInstance();
 
+  /**
+   * @brief Number of journal entries that triggers a checkpoint.
+   */
+  static constexpr size_t JOURNAL_ENTRIES = 4096;
+
   /**
    * @brief Adds new timestamp to component's index.
    *
+   * Appending a timestamp not older than the newest one is O(1); older ones are inserted at their
+   * position found by binary search.
+   *
    * @param component
    *   Name of the hardware component (GPU/CPU/Motherboard)
    * @param timestamp
@@ -32,62 +87,99 @@ public:
   void addIndex(const std::string& component, long long timestamp);
 
   /**
-   * @brief Gets all timestamps for specified component.
+   * @brief Gets a snapshot of the timestamps of specified component without copying them.
    *
    * @param component
    *   Name of the hardware component
    *
-   * @return vector<long long>
-   *   Vector of timestamps sorted in ascending order
+   * @return Snapshot
+   *   Timestamps sorted in ascending order, empty if the component has none
    */
-  std::vector<long long> getTimestamps(const std::string& component) const;
+  Snapshot getSnapshot(const std::string& component) const;
 
   /**
-   * @brief Gets most recent timestamps for specified component.
+   * @brief Gets timestamps within the range [from, to) for specified component.
+   *
+   * The range is found by two binary searches, so only the returned timestamps are copied.
    *
    * @param component
    *   Name of the hardware component
-   * @param count
-   *   Number of timestamps to return
+   * @param from
+   *   First timestamp of the range
+   * @param to
+   *   Timestamp one past the range
    *
    * @return vector<long long>
-   *   Vector of latest timestamps, sorted in ascending order
+   *   Vector of timestamps, sorted in ascending order
    */
-  std::vector<long long> getLatestTimestamps(const std::string& component, size_t count) const;
+  std::vector<long long> getRange(const std::string& component, long long from,
+                                  long long to) const;
 
   /**
-   * @brief Gets oldest timestamps for specified component.
+   * @brief Removes specified timestamps from component's index.
+   *
+   * The timestamps are sorted and merged with the index in one linear pass. Every listed timestamp
+   * removes one entry.
    *
    * @param component
    *   Name of the hardware component
-   * @param count
-   *   Number of timestamps to return
+   * @param timestamps
+   *   Vector of timestamps to remove from index
+   */
+  void deleteTimestamps(const std::string& component, const std::vector<long long>& timestamps);
+
+  /**
+   * @brief Removes timestamps older than the given one from component's index.
    *
-   * @return vector<long long>
-   *   Vector of oldest timestamps, sorted in ascending order
+   * @param component
+   *   Name of the hardware component
+   * @param timestamp
+   *   Oldest timestamp to keep
    */
-  std::vector<long long> getOldestTimestamps(const std::string& component, size_t count) const;
+  void deleteOlderThan(const std::string& component, long long timestamp);
 
   /**
-   * @brief Removes specified timestamps from component's index.
+   * @brief Removes timestamps within the range [from, to) from component's index.
+   *
+   * @param component
+   *   Name of the hardware component
+   * @param from
+   *   First timestamp to remove
+   * @param to
+   *   Timestamp one past the removed range
+   */
+  void deleteRange(const std::string& component, long long from, long long to);
+
+  /**
+   * @brief Adds the given timestamps the index of a component lacks.
+   *
+   * Every given timestamp is matched with one entry, so records indexed before a crash are not
+   * indexed twice and entries of records stored elsewhere are kept.
    *
    * @param component
    *   Name of the hardware component
    * @param timestamps
-   *   Vector of timestamps to remove from index
+   *   Timestamps of stored measurements of the component
    */
-  void deleteTimestamps(const std::string& component, const std::vector<long long>& timestamps);
+  void mergeIndex(const std::string& component, std::vector<long long> timestamps);
 
   /**
-   * @brief Saves current index state to JSON file.
+   * @brief Saves current index state to the binary snapshot as a checkpoint and empties the
+   * journal.
    */
-  void saveIndex() const;
+  void saveIndex();
 
   /**
-   * @brief Loads index from JSON file.
+   * @brief Maps the binary snapshot, or loads the JSON file of older versions, and replays the
+   * journal on top of it.
    */
   void loadIndex();
 
+  /**
+   * @brief Writes the buffered journal lines to the journal file.
+   */
+  void flushJournal();
+
 private:
   /**
    * @brief Private constructor for singleton pattern.
@@ -95,13 +187,125 @@ private:
   IndexManager();
 
   /**
-   * @brief Gets path to index file.
+   * @brief Gets path to index file of older versions.
    *
    * @return string
    *   Full path to index.json file
    */
   std::string getIndexPath() const;
 
-  std::unordered_map<std::string, std::vector<long long>> index;
+  /**
+   * @brief Gets path to binary index snapshot.
+   *
+   * @return string
+   *   Full path to index.bin file
+   */
+  std::string getSnapshotPath() const;
+
+  /**
+   * @brief Maps the binary index snapshot; the caller holds the mutex.
+   *
+   * @return bool
+   *   False if the snapshot is missing or damaged
+   */
+  bool mapSnapshot();
+
+  /**
+   * @brief Loads the index from the JSON file of older versions; the caller holds the mutex.
+   *
+   * @return bool
+   *   False if there is no such file
+   */
+  bool loadLegacyIndex();
+
+  /**
+   * @brief Copies the timestamps of a component out of the mapped snapshot if they are still
+   * there; the caller holds the mutex.
+   *
+   * @param component
+   *   Name of the hardware component
+   */
+  void materialize(const std::string& component);
+
+  /**
+   * @brief Gets path to journal file.
+   *
+   * @return string
+   *   Full path to index.journal file
+   */
+  std::string getJournalPath() const;
+
+  /**
+   * @brief Appends a change to the journal, taking a checkpoint once the journal is full.
+   *
+   * @param operation
+   *   'a' for an added timestamp, 'd' for a deleted one, 'r' for a deleted range
+   * @param component
+   *   Name of the hardware component
+   * @param timestamp
+   *   Timestamp of the change, first timestamp of a range
+   * @param end
+   *   Timestamp one past a range, unused otherwise
+   */
+  void logChange(char operation, const std::string& component, long long timestamp,
+                 long long end = 0);
+
+  /**
+   * @brief Applies a change read from the journal to the index.
+   *
+   * @param operation
+   *   Operation passed to logChange()
+   * @param component
+   *   Name of the hardware component
+   * @param timestamp
+   *   Timestamp of the change, first timestamp of a range
+   * @param end
+   *   Timestamp one past a range, unused otherwise
+   */
+  void applyChange(char operation, const std::string& component, long long timestamp,
+                   long long end = 0);
+
+  /**
+   * @brief Gets the timestamps of a component for changing them, copying them first if a
+   * snapshot of them may be alive.
+   *
+   * @param component
+   *   Name of the hardware component
+   * @param append
+   *   True if one timestamp is only appended, which leaves published views unchanged
+   *
+   * @return vector<long long>&
+   *   Timestamps safe to change
+   */
+  std::vector<long long>& getWritable(const std::string& component, bool append = false);
+
+  /**
+   * @brief Publishes the current timestamps of every component to readers; the caller holds the
+   * mutex.
+   */
+  void publishLocked();
+
+  /**
+   * @brief Writes the checkpoint and starts a new journal; the caller holds the mutex.
+   */
+  void saveLocked();
+
+  /**
+   * @brief Empties the journal and writes its generation line; the caller holds the mutex.
+   */
+  void startJournal();
+
+  // Components are copied out of the mapped snapshot when first changed.
+  std::unordered_map<std::string, std::shared_ptr<std::vector<long long>>> index;
+  std::unordered_map<std::string, std::pair<const char*, size_t>> mapped;
+  std::shared_ptr<MappedFile> snapshotFile;
+  // Loaded and stored with std::atomic_load and std::atomic_store only.
+  std::shared_ptr<const std::unordered_map<std::string, Snapshot>> published;
+  std::mutex mutex;
+  std::ofstream journal;
+  size_t journalEntries;
+  uint64_t generation;
   static constexpr const char* INDEX_FILENAME = "index.json";
+  static constexpr const char* SNAPSHOT_FILENAME = "index.bin";
+  static constexpr const char* JOURNAL_FILENAME = "index.journal";
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+// Standard library headers
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The mapping lives as long as the object. Files replaced by rename stay readable through an
+ * existing mapping, but a file truncated in place must not be read past its new size.
+ */
+class MappedFile {
+public:
+  /**
+   * @brief Maps a file into memory.
+   *
+   * @param path
+   *   Path to the file
+   *
+   * @throws std::runtime_error
+   *   If the file cannot be opened or mapped
+   */
+  explicit MappedFile(const std::string& path);
+
+  /**
+   * @brief Unmaps the file.
+   */
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * @brief Gets pointer to the first byte of the file.
+   *
+   * @return const char*
+   *   Mapped bytes, nullptr for an empty file
+   */
+  const char* data() const;
+
+  /**
+   * @brief Gets size of the mapped file.
+   *
+   * @return size_t
+   *   Size in bytes
+   */
+  size_t size() const;
+
+private:
+  const char* bytes;
+  size_t length;
+};
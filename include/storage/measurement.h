@@ -2,6 +2,7 @@
 #define MEASUREMENT_H
 
 // Standard library headers
+#include <cstddef>
 #include <string>
 
 /**
@@ -23,6 +24,12 @@ struct Measurement {
    * @brief Unix timestamp when measurement was taken.
    */
   long long timestamp;
+
+  /**
+   * @brief Position among the measurements of the component sharing the timestamp, in the order
+   * they were stored; set when read from the storage engine.
+   */
+  size_t sequence = 0;
 };
 
 #endif
@@ -2,6 +2,8 @@
 
 // Standard library headers
 #include <memory>
+#include <string>
+#include <vector>
 
 // Project headers
 #include "inputs/data_source.h"
@@ -42,6 +44,16 @@ private:
    */
   MeasurementHandler();
 
+  /**
+   * @brief Shortest accepted measurement interval, in milliseconds.
+   */
+  static constexpr int MIN_INTERVAL_MS = 10;
+
+  /**
+   * @brief Longest accepted measurement interval, in milliseconds.
+   */
+  static constexpr int MAX_INTERVAL_MS = 24 * 60 * 60 * 1000;
+
   StorageManager storage;             ///< Storage manager instance.
   std::unique_ptr<DataSource> source; ///< Source of measurement data.
 
@@ -70,32 +82,27 @@ private:
    * @brief Asks the user for the measurement interval.
    *
    * @return int
-   *   Interval between measurements in seconds.
+   *   Interval between measurements in milliseconds.
    */
   int askForInterval();
 
   /**
-   * @brief Executes the monitoring process for a given component.
+   * @brief Executes the monitoring process for a given component on drift-free deadlines.
    *
    * @param component
    *   Name of the component to monitor.
    * @param duration
    *   Total monitoring time in seconds.
    * @param interval
-   *   Time between measurements in seconds.
+   *   Time between measurements in milliseconds.
    */
   void performMonitoring(const std::string& component, int duration, int interval);
 
   /**
-   * @brief Records a single temperature measurement for a component.
+   * @brief Records temperature measurements of components from one snapshot of the source.
    *
-   * @param component
-   *   Name of the component to measure.
-   */
-  void recordMeasurement(const std::string& component);
-
-  /**
-   * @brief Records temperature measurements for all components (GPU, CPU, Motherboard).
+   * @param components
+   *   Names of the components to measure.
    */
-  void recordAllMeasurements();
+  void recordMeasurements(const std::vector<std::string>& components);
 };
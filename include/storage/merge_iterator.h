@@ -0,0 +1,86 @@
+#pragma once
+
+// Standard library headers
+#include <queue>
+#include <vector>
+
+// Project headers
+#include "storage/measurement.h"
+
+/**
+ * @brief Merges several timestamp-ordered series into one series ordered by timestamp.
+ *
+ * A min-heap holds the next record of every series, so each step costs O(log k) for k series.
+ * Records with equal timestamps are returned in the order of their series, and the order within
+ * a series is preserved, which makes every prefix or suffix of the merged series consist of a
+ * prefix or suffix of each input series.
+ */
+class MergeIterator {
+public:
+  /**
+   * @brief Creates an iterator over the given series.
+   *
+   * @param series
+   *   Series to merge, each ordered by timestamp
+   */
+  explicit MergeIterator(std::vector<std::vector<Measurement>> series);
+
+  /**
+   * @brief Gets the next record of the merged series.
+   *
+   * @param out
+   *   Receives the record
+   *
+   * @return bool
+   *   False when all series are exhausted
+   */
+  bool next(Measurement& out);
+
+  /**
+   * @brief Gets the next record of the merged series and the series it comes from.
+   *
+   * @param out
+   *   Receives the record
+   * @param index
+   *   Receives the index of the series holding the record
+   *
+   * @return bool
+   *   False when all series are exhausted
+   */
+  bool next(Measurement& out, size_t& index);
+
+private:
+  /**
+   * @brief Position of the next record within one of the series.
+   */
+  struct Cursor {
+    /**
+     * @brief Timestamp of the record at the position.
+     */
+    long long timestamp;
+
+    /**
+     * @brief Index of the series.
+     */
+    size_t series;
+
+    /**
+     * @brief Position within the series.
+     */
+    size_t position;
+
+    /**
+     * @brief Orders cursors so that the heap top holds the oldest record.
+     *
+     * @param other
+     *   Cursor to compare with
+     *
+     * @return bool
+     *   True if this cursor comes after the other one
+     */
+    bool operator>(const Cursor& other) const;
+  };
+
+  std::vector<std::vector<Measurement>> series;
+  std::priority_queue<Cursor, std::vector<Cursor>, std::greater<Cursor>> heap;
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+// Standard library headers
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Project headers
+#include "storage/measurement.h"
+
+/**
+ * @brief Aggregate of the measurements of a series within one time bucket.
+ */
+struct Rollup {
+  /**
+   * @brief First timestamp covered by the bucket.
+   */
+  int64_t start;
+
+  /**
+   * @brief Lowest temperature.
+   */
+  double min;
+
+  /**
+   * @brief Highest temperature.
+   */
+  double max;
+
+  /**
+   * @brief Sum of the temperatures.
+   */
+  double sum;
+
+  /**
+   * @brief Number of measurements.
+   */
+  uint64_t count;
+};
+
+static_assert(sizeof(Rollup) == 40, "Rollup must be 40 bytes");
+
+/**
+ * @brief Keeps per-minute and per-hour rollups of every series, updated as records arrive.
+ *
+ * Buckets are aligned to multiples of their width. Every series is saved to its own
+ * "<Component>.rollups" file in the segments directory, laid out as a header, the number of
+ * minute buckets, the minute buckets, the number of hour buckets and the hour buckets. The header
+ * holds the newest log sequence number folded into the file, which tells recovery which logged
+ * records still have to be added.
+ *
+ * The store is not synchronized; the caller serializes access.
+ */
+class RollupStore {
+public:
+  /**
+   * @brief Width of the buckets of the fine tier, in timestamp units.
+   */
+  static constexpr int64_t MINUTE = 60;
+
+  /**
+   * @brief Width of the buckets of the coarse tier, in timestamp units.
+   */
+  static constexpr int64_t HOUR = 60 * 60;
+
+  /**
+   * @brief Adds a measurement to the buckets of both tiers holding it.
+   *
+   * @param record
+   *   Measurement to add
+   */
+  void add(const Measurement& record);
+
+  /**
+   * @brief Removes buckets of both tiers starting within the range [begin, end).
+   *
+   * @param series
+   *   Name of the component
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   */
+  void erase(const std::string& series, int64_t begin, int64_t end);
+
+  /**
+   * @brief Removes buckets of one tier that end before a timestamp.
+   *
+   * @param series
+   *   Name of the component
+   * @param width
+   *   MINUTE or HOUR
+   * @param timestamp
+   *   Oldest timestamp to keep
+   */
+  void expire(const std::string& series, int64_t width, int64_t timestamp);
+
+  /**
+   * @brief Gets buckets of a tier starting within the range [begin, end).
+   *
+   * @param series
+   *   Name of the component
+   * @param width
+   *   MINUTE or HOUR
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   *
+   * @return std::vector<Rollup>
+   *   Buckets ordered by start
+   */
+  std::vector<Rollup> read(const std::string& series, int64_t width, int64_t begin,
+                           int64_t end) const;
+
+  /**
+   * @brief Loads the rollups of a series from its file.
+   *
+   * @param series
+   *   Name of the component
+   * @param lsn
+   *   Receives the newest log sequence number folded into the file
+   *
+   * @return bool
+   *   False if the file is missing or damaged; the series then has no buckets
+   */
+  bool load(const std::string& series, uint64_t& lsn);
+
+  /**
+   * @brief Durably writes the rollups of every series changed since the last save.
+   *
+   * @param lsn
+   *   Newest log sequence number folded into the rollups
+   *
+   * @throws std::runtime_error
+   *   If a file cannot be written
+   */
+  void save(uint64_t lsn);
+
+  /**
+   * @brief Folds a bucket into another one.
+   *
+   * @param into
+   *   Bucket receiving the measurements
+   * @param from
+   *   Bucket to add
+   */
+  static void combine(Rollup& into, const Rollup& from);
+
+  /**
+   * @brief Gets the start of the bucket of a given width holding a timestamp.
+   *
+   * @param timestamp
+   *   Timestamp of a record
+   * @param width
+   *   Width of the bucket
+   *
+   * @return int64_t
+   *   First timestamp of the bucket
+   */
+  static int64_t align(int64_t timestamp, int64_t width);
+
+private:
+  /**
+   * @brief Gets path to the rollup file of a series.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return std::string
+   *   Full path to the file
+   */
+  std::string getPath(const std::string& series) const;
+
+  std::unordered_map<std::string, std::map<int64_t, Rollup>> minutes;
+  std::unordered_map<std::string, std::map<int64_t, Rollup>> hours;
+  std::set<std::string> dirty;
+
+  static constexpr const char* ROLLUP_EXTENSION = ".rollups";
+};
@@ -0,0 +1,353 @@
+#pragma once
+
+// Standard library headers
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Project headers
+#include "storage/mapped_file.h"
+#include "storage/measurement.h"
+
+/**
+ * @brief Header written at the beginning of every segment file.
+ */
+struct SegmentHeader {
+  /**
+   * @brief File signature, always "HSEG".
+   */
+  char magic[4];
+
+  /**
+   * @brief Version of the segment format.
+   */
+  uint32_t version;
+
+  /**
+   * @brief Size of a single record in bytes.
+   */
+  uint32_t recordSize;
+
+  /**
+   * @brief Reserved for future use, always zero.
+   */
+  uint32_t reserved;
+};
+
+/**
+ * @brief Fixed-size binary representation of a single measurement.
+ */
+struct SegmentRecord {
+  /**
+   * @brief Identifier of the component, resolved through SegmentLog::getComponentName().
+   */
+  uint32_t componentId;
+
+  /**
+   * @brief Padding keeping the record 8-byte aligned, always zero.
+   */
+  uint32_t reserved;
+
+  /**
+   * @brief Temperature value in Celsius.
+   */
+  double temperature;
+
+  /**
+   * @brief Unix timestamp when measurement was taken.
+   */
+  int64_t timestamp;
+};
+
+static_assert(sizeof(SegmentHeader) == 16, "SegmentHeader must be 16 bytes");
+static_assert(sizeof(SegmentRecord) == 24, "SegmentRecord must be 24 bytes");
+
+/**
+ * @brief Read-only view over a range of records of a memory-mapped segment.
+ *
+ * The view shares ownership of the mapping, so it stays valid after the segment is rewritten;
+ * it must not be used after the segment is truncated in place.
+ */
+class SegmentView {
+public:
+  /**
+   * @brief Creates an empty view.
+   */
+  SegmentView();
+
+  /**
+   * @brief Creates a view over records of a mapped segment.
+   *
+   * @param file
+   *   Mapping that holds the records
+   * @param first
+   *   Pointer to the first record of the view
+   * @param count
+   *   Number of records in the view
+   */
+  SegmentView(std::shared_ptr<const MappedFile> file, const SegmentRecord* first, size_t count);
+
+  /**
+   * @brief Gets pointer to the first record.
+   *
+   * @return const SegmentRecord*
+   *   First record of the view
+   */
+  const SegmentRecord* begin() const;
+
+  /**
+   * @brief Gets pointer one past the last record.
+   *
+   * @return const SegmentRecord*
+   *   End of the view
+   */
+  const SegmentRecord* end() const;
+
+  /**
+   * @brief Gets number of records in the view.
+   *
+   * @return size_t
+   *   Number of records
+   */
+  size_t size() const;
+
+  /**
+   * @brief Checks whether the view holds no records.
+   *
+   * @return bool
+   *   True if the view is empty
+   */
+  bool empty() const;
+
+  /**
+   * @brief Gets a record of the view.
+   *
+   * @param index
+   *   Position of the record within the view
+   *
+   * @return const SegmentRecord&
+   *   Record at the position
+   */
+  const SegmentRecord& operator[](size_t index) const;
+
+private:
+  std::shared_ptr<const MappedFile> file;
+  const SegmentRecord* first;
+  size_t count;
+};
+
+/**
+ * @brief Storage of fixed-size measurement records, one segment file per series.
+ *
+ * Segments are written whole; the storage engine uses them for its sorted runs.
+ */
+class SegmentLog {
+public:
+  /**
+   * @brief Name of the virtual series merging records of all components; it has no segment.
+   */
+  static constexpr const char* ALL_SERIES = "all_measurements";
+
+  /**
+   * @brief Extension of segment files.
+   */
+  static constexpr const char* SEGMENT_EXTENSION = ".seg";
+
+  /**
+   * @brief Gets singleton instance of SegmentLog.
+   *
+   * @return SegmentLog&
+   *   Reference to the singleton instance
+   */
+  static SegmentLog& getInstance();
+
+  /**
+   * @brief Checks whether a segment file exists for the series.
+   *
+   * @param series
+   *   Name of the series
+   *
+   * @return bool
+   *   True if the segment file exists
+   */
+  bool exists(const std::string& series) const;
+
+  /**
+   * @brief Gets number of complete records stored in the series segment.
+   *
+   * @param series
+   *   Name of the series
+   *
+   * @return size_t
+   *   Number of records, 0 if the segment does not exist
+   */
+  size_t count(const std::string& series) const;
+
+  /**
+   * @brief Maps the series segment and returns a view over records in the range [begin, end).
+   *
+   * No record is parsed or copied.
+   *
+   * @param series
+   *   Name of the series
+   * @param begin
+   *   Position of the first record of the view
+   * @param end
+   *   Position one past the last record of the view
+   *
+   * @return SegmentView
+   *   View over the records, clamped to the size of the segment
+   *
+   * @throws std::runtime_error
+   *   If the segment cannot be mapped or is not a valid segment file
+   */
+  SegmentView view(const std::string& series, size_t begin, size_t end) const;
+
+  /**
+   * @brief Reads records in the range [begin, end) from the series segment.
+   *
+   * @param series
+   *   Name of the series
+   * @param begin
+   *   Position of the first record to read
+   * @param end
+   *   Position one past the last record to read
+   *
+   * @return std::vector<Measurement>
+   *   Records in the order they were appended
+   *
+   * @throws std::runtime_error
+   *   If the segment cannot be opened or is not a valid segment file
+   */
+  std::vector<Measurement> read(const std::string& series, size_t begin, size_t end) const;
+
+  /**
+   * @brief Atomically and durably replaces the content of the series segment.
+   *
+   * @param series
+   *   Name of the series
+   * @param records
+   *   Records that make up the new segment
+   *
+   * @throws std::runtime_error
+   *   If the segment cannot be written
+   */
+  void rewrite(const std::string& series, const std::vector<Measurement>& records);
+
+  /**
+   * @brief Drops records past the given position from the series segment.
+   *
+   * @param series
+   *   Name of the series
+   * @param count
+   *   Number of records to keep
+   *
+   * @throws std::runtime_error
+   *   If the segment cannot be truncated
+   */
+  void truncate(const std::string& series, size_t count);
+
+  /**
+   * @brief Removes the series segment.
+   *
+   * @param series
+   *   Name of the series
+   *
+   * @throws std::runtime_error
+   *   If the segment exists and cannot be removed
+   */
+  void remove(const std::string& series);
+
+  /**
+   * @brief Gets names of all registered components.
+   *
+   * @return std::vector<std::string>
+   *   Component names in the order they were registered, without ALL_SERIES
+   */
+  std::vector<std::string> getSeries() const;
+
+  /**
+   * @brief Gets identifier of a component, registering it if needed.
+   *
+   * @param component
+   *   Name of the hardware component
+   *
+   * @return uint32_t
+   *   Identifier stored in segment records
+   */
+  uint32_t getComponentId(const std::string& component);
+
+  /**
+   * @brief Gets component name for an identifier.
+   *
+   * @param id
+   *   Identifier stored in segment records
+   *
+   * @return std::string
+   *   Name of the hardware component
+   *
+   * @throws std::runtime_error
+   *   If the identifier is not registered
+   */
+  std::string getComponentName(uint32_t id) const;
+
+  /**
+   * @brief Gets path to the segment file of a series.
+   *
+   * @param series
+   *   Name of the series
+   *
+   * @return std::string
+   *   Full path to the segment file
+   */
+  std::string getSegmentPath(const std::string& series) const;
+
+  /**
+   * @brief Gets path to the directory holding segment files.
+   *
+   * @return std::string
+   *   Full path to the segments directory
+   */
+  std::string getSegmentDirectory() const;
+
+private:
+  /**
+   * @brief Private constructor for singleton pattern.
+   */
+  SegmentLog();
+
+  /**
+   * @brief Converts a measurement into its binary form.
+   *
+   * @param record
+   *   Measurement to convert
+   *
+   * @return SegmentRecord
+   *   Binary record
+   */
+  SegmentRecord toSegmentRecord(const Measurement& record);
+
+  /**
+   * @brief Loads component registry from JSON file.
+   */
+  void loadRegistry();
+
+  /**
+   * @brief Saves component registry to JSON file.
+   *
+   * @throws std::runtime_error
+   *   If the registry cannot be written
+   */
+  void saveRegistry() const;
+
+  std::unordered_map<std::string, uint32_t> componentIds;
+  std::vector<std::string> componentNames;
+  mutable std::mutex registryMutex;
+
+  static constexpr const char* SEGMENT_DIRNAME = "segments";
+  static constexpr const char* REGISTRY_FILENAME = "series.json";
+  static constexpr uint32_t SEGMENT_VERSION = 1;
+};
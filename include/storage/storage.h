@@ -8,15 +8,18 @@
 #include "storage/measurement.h"
 
 /**
- * @brief Class responsible for saving records to a file.
+ * @brief Class responsible for saving records to the storage engine.
  */
 class StorageManager {
 public:
   /**
-   * @brief Saves a single record to a file.
+   * @brief Stores a single record through the storage engine, which logs it first.
    *
    * @param record
    *   Measurement record to save.
+   *
+   * @throws std::runtime_error
+   *   If the write-ahead log cannot be written.
    */
   void saveRecord(const Measurement& record);
 };
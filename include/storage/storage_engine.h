@@ -0,0 +1,812 @@
+#pragma once
+
+// Standard library headers
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
+// Project headers
+#include "storage/measurement.h"
+#include "storage/rollup_store.h"
+
+/**
+ * @brief Log-structured storage of measurement series.
+ *
+ * Records are logged to the write-ahead log and inserted into a sorted in-memory buffer of their
+ * series (memtable). A memtable holding MEMTABLE_RECORDS records is frozen and a background
+ * thread writes it as an immutable sorted run: a segment named "<series>.<lsn>", where lsn is
+ * the newest log sequence number it holds. Once a series has COMPACTION_RUNS runs, the thread
+ * merges them into the Gorilla-compressed chunk files of the series, one per time partition of
+ * PARTITION_SECONDS. Reads merge the partitions, the runs and the memtables by timestamp; old
+ * data is dropped by removing whole partition files.
+ *
+ * Records sharing a timestamp keep the order they were inserted in: memtables insert behind equal
+ * timestamps and merges take the parts from the oldest, so the position of a record among the
+ * records of its timestamp (its sequence) is stable and tells samples taken within the same
+ * second apart. Reads return every record with its sequence, counted over all records of the
+ * timestamp even when a reading or a tombstone leaves some of them out.
+ *
+ * Deleting records writes a tombstone to "tombstones.json" in the segments directory: the first
+ * and last deleted record, each as a timestamp and sequence, and the newest log sequence number
+ * stored in the series at that time. Readers skip the records between the two ends that are not
+ * newer than the tombstone, so records inserted later are never hidden. Once PURGE_TOMBSTONES
+ * tombstones exist, the background thread rewrites the affected partitions and runs without the
+ * dead records and drops the tombstones; a series is also purged before its runs are compacted,
+ * which would otherwise move newer records into the partitions covered by its tombstones.
+ *
+ * Every insert also updates the minute and hour rollups of its series, which checkpoints save
+ * together with the sequence number they cover.
+ *
+ * Retention policies from the configuration bound how long raw records and rollups are kept. The
+ * background thread enforces them every RETENTION_INTERVAL by removing whole partition files and
+ * rollup buckets, never by rewriting files.
+ *
+ * The manifest ("manifest.json" in the segments directory) records how many measurements every
+ * partition holds and the newest sequence number compacted into the series, which tells recovery
+ * which bytes and runs are valid and which log records are already stored.
+ */
+class StorageEngine {
+public:
+  /**
+   * @brief Number of records a memtable collects before it is written as a run.
+   */
+  static constexpr size_t MEMTABLE_RECORDS = 256;
+
+  /**
+   * @brief Number of runs of a series that triggers their compaction.
+   */
+  static constexpr size_t COMPACTION_RUNS = 4;
+
+  /**
+   * @brief Length of a time partition of the compacted history, in timestamp units.
+   */
+  static constexpr int64_t PARTITION_SECONDS = 24 * 60 * 60;
+
+  /**
+   * @brief Number of tombstones that triggers purging the deleted records.
+   */
+  static constexpr size_t PURGE_TOMBSTONES = 8;
+
+  /**
+   * @brief How long the data of a series is kept, in timestamp units; 0 keeps it forever.
+   */
+  struct Retention {
+    /**
+     * @brief Age after which raw records are dropped.
+     */
+    long long raw = 0;
+
+    /**
+     * @brief Age after which minute rollups are dropped.
+     */
+    long long minute = 0;
+
+    /**
+     * @brief Age after which hour rollups are dropped.
+     */
+    long long hour = 0;
+  };
+
+  /**
+   * @brief Parses a retention policy such as "raw:7d, minute:90d, hour:forever".
+   *
+   * Periods are a positive number followed by s, m, h, d or w, or "forever"; tiers left out are
+   * kept forever.
+   *
+   * @param value
+   *   Policy from the configuration
+   *
+   * @return Retention
+   *   Parsed policy
+   *
+   * @throws std::invalid_argument
+   *   If the policy is malformed
+   */
+  static Retention parseRetention(const std::string& value);
+
+  /**
+   * @brief Gets singleton instance of StorageEngine, recovering the storage on first use.
+   *
+   * @return StorageEngine&
+   *   Reference to the singleton instance
+   *
+   * @throws std::runtime_error
+   *   If the storage cannot be recovered
+   */
+  static StorageEngine& getInstance();
+
+  /**
+   * @brief Stops the background thread and writes all memtables as runs.
+   */
+  ~StorageEngine();
+
+  /**
+   * @brief Logs a record and inserts it into the memtable of its series.
+   *
+   * @param record
+   *   Measurement to store
+   *
+   * @throws std::runtime_error
+   *   If the write-ahead log cannot be written
+   */
+  void insert(const Measurement& record);
+
+  /**
+   * @brief Reads the oldest or newest records of a series.
+   *
+   * @param series
+   *   Name of the component
+   * @param count
+   *   Number of records to read, 0 or less for all records
+   * @param fromStart
+   *   True to read the oldest records, false to read the newest ones
+   *
+   * @return std::vector<Measurement>
+   *   Records ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If a run or a partition cannot be read
+   */
+  std::vector<Measurement> read(const std::string& series, int count, bool fromStart);
+
+  /**
+   * @brief Reads records of a series with timestamps in the range [begin, end).
+   *
+   * Only the partitions overlapping the range are opened.
+   *
+   * @param series
+   *   Name of the component
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   *
+   * @return std::vector<Measurement>
+   *   Records ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If a run or a partition cannot be read
+   */
+  std::vector<Measurement> readRange(const std::string& series, long long begin, long long end);
+
+  /**
+   * @brief Reads min/max/sum/count buckets of a series covering the range [begin, end).
+   *
+   * Buckets are step wide and aligned to multiples of step. They are combined from the coarsest
+   * rollup tier whose width divides step, so 30 days at a step of one hour take 720 hour buckets;
+   * other steps are computed from the records. Empty buckets are left out.
+   *
+   * @param series
+   *   Name of the component
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   * @param step
+   *   Width of the buckets, in timestamp units
+   *
+   * @return std::vector<Rollup>
+   *   Buckets ordered by start
+   *
+   * @throws std::runtime_error
+   *   If step is not positive or the records cannot be read
+   */
+  std::vector<Rollup> readRollups(const std::string& series, long long begin, long long end,
+                                  long long step);
+
+  /**
+   * @brief Finds records of a series with timestamps in the range [begin, end) and temperatures
+   * within [low, high].
+   *
+   * Every chunk keeps the lowest and highest temperature it holds, so chunks that cannot match
+   * are skipped without being decoded; threshold searches over long histories only decode the
+   * chunks around the matches.
+   *
+   * @param series
+   *   Name of the component
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   * @param low
+   *   Lowest matching temperature
+   * @param high
+   *   Highest matching temperature
+   *
+   * @return std::vector<Measurement>
+   *   Matching records ordered by timestamp
+   *
+   * @throws std::runtime_error
+   *   If a run or a partition cannot be read
+   */
+  std::vector<Measurement> findTemperature(const std::string& series, long long begin,
+                                           long long end, double low, double high);
+
+  /**
+   * @brief Checks whether records of a series were ever stored by the engine.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return bool
+   *   True if the series is registered
+   */
+  bool exists(const std::string& series);
+
+  /**
+   * @brief Gets names of all series stored by the engine.
+   *
+   * @return std::vector<std::string>
+   *   Component names
+   */
+  std::vector<std::string> getSeries();
+
+  /**
+   * @brief Deletes the oldest or newest records of a series by writing a tombstone.
+   *
+   * The records stay in their files until the background thread purges them. Exactly count
+   * records are deleted, also when they share timestamps with records that are kept; records
+   * inserted afterwards are never hidden by the tombstone.
+   *
+   * @param series
+   *   Name of the component
+   * @param count
+   *   Number of records to delete, 0 or less for all records
+   * @param fromStart
+   *   True to delete the oldest records, false to delete the newest ones
+   *
+   * @return std::vector<long long>
+   *   Timestamps of the deleted records
+   *
+   * @throws std::runtime_error
+   *   If a run or a partition cannot be read or the tombstones cannot be written
+   */
+  std::vector<long long> remove(const std::string& series, int count, bool fromStart);
+
+  /**
+   * @brief Deletes records of a series with timestamps in the range [begin, end) by writing a
+   * tombstone.
+   *
+   * The tombstone spans the first to the last deleted record, with the same semantics as the ones
+   * written by remove().
+   *
+   * @param series
+   *   Name of the component
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   *
+   * @return std::vector<long long>
+   *   Timestamps of the deleted records
+   *
+   * @throws std::runtime_error
+   *   If a run or a partition cannot be read or the tombstones cannot be written
+   */
+  std::vector<long long> removeRange(const std::string& series, long long begin, long long end);
+
+  /**
+   * @brief Deletes records of a series older than a timestamp.
+   *
+   * Partitions entirely older than the timestamp are removed without being read; only the
+   * partition holding the timestamp and the runs are rewritten. Tombstones older than the
+   * timestamp are dropped.
+   *
+   * @param series
+   *   Name of the component
+   * @param timestamp
+   *   Oldest timestamp to keep
+   *
+   * @return size_t
+   *   Number of deleted records that were still visible, leaving out those hidden by tombstones
+   *
+   * @throws std::runtime_error
+   *   If a run or a partition cannot be rewritten
+   */
+  size_t dropBefore(const std::string& series, long long timestamp);
+
+  /**
+   * @brief Writes all memtables as runs and empties the write-ahead log.
+   *
+   * Inserts wait while the checkpoint is taken.
+   *
+   * @throws std::runtime_error
+   *   If a run or the write-ahead log cannot be written
+   */
+  void checkpoint();
+
+private:
+  /**
+   * @brief Sorted in-memory buffer of a series.
+   */
+  struct MemTable {
+    /**
+     * @brief Records ordered by timestamp.
+     */
+    std::vector<Measurement> records;
+
+    /**
+     * @brief Newest log sequence number of the records.
+     */
+    uint64_t lsn = 0;
+  };
+
+  /**
+   * @brief Immutable sorted run of a series.
+   */
+  struct Run {
+    /**
+     * @brief Newest log sequence number of the records, which also names the run.
+     */
+    uint64_t lsn;
+
+    /**
+     * @brief Number of records.
+     */
+    size_t count;
+  };
+
+  /**
+   * @brief Deleted records of a series, from the first to the last one, both inclusive.
+   */
+  struct Tombstone {
+    /**
+     * @brief Timestamp of the first deleted record.
+     */
+    long long first;
+
+    /**
+     * @brief Sequence of the first deleted record among the records of its timestamp.
+     */
+    size_t firstSequence;
+
+    /**
+     * @brief Timestamp of the last deleted record.
+     */
+    long long last;
+
+    /**
+     * @brief Sequence of the last deleted record among the records of its timestamp.
+     */
+    size_t lastSequence;
+
+    /**
+     * @brief Newest log sequence number stored in the series when the tombstone was written; newer
+     * records are never hidden.
+     */
+    uint64_t lsn;
+  };
+
+  /**
+   * @brief Parts of a series captured under the mutex.
+   */
+  struct SeriesState {
+    /**
+     * @brief Number of records in every partition, by first timestamp of the partition.
+     */
+    std::map<int64_t, size_t> partitions;
+
+    /**
+     * @brief Runs from the oldest.
+     */
+    std::vector<Run> runs;
+
+    /**
+     * @brief Records of the frozen memtables and of the memtable, each ordered by timestamp.
+     */
+    std::vector<std::vector<Measurement>> buffered;
+
+    /**
+     * @brief Tombstones of the series.
+     */
+    std::vector<Tombstone> tombstones;
+  };
+
+  /**
+   * @brief Private constructor for singleton pattern; recovers the storage and starts the
+   * background thread.
+   */
+  StorageEngine();
+
+  /**
+   * @brief Brings files back to the state recorded by the manifest and replays the log.
+   */
+  void recover();
+
+  /**
+   * @brief Migrates a segment written record by record by older versions into a run.
+   *
+   * @param series
+   *   Name of the component
+   * @param state
+   *   Checkpoint written by the older version
+   */
+  void migrateSegment(const std::string& series, const nlohmann::json& state);
+
+  /**
+   * @brief Splits the unpartitioned chunk file of older versions into partitions.
+   *
+   * @param series
+   *   Name of the component
+   */
+  void migrateChunks(const std::string& series);
+
+  /**
+   * @brief Finds runs in the segments directory.
+   */
+  void loadRuns();
+
+  /**
+   * @brief Inserts a logged record into the memtable of its series, freezing a full memtable.
+   *
+   * The caller must hold the mutex.
+   *
+   * @param lsn
+   *   Log sequence number of the record
+   * @param record
+   *   Measurement to insert
+   */
+  void insertLocked(uint64_t lsn, const Measurement& record);
+
+  /**
+   * @brief Background loop writing frozen memtables, taking checkpoints, compacting runs and
+   * purging deleted records.
+   */
+  void backgroundLoop();
+
+  /**
+   * @brief Drops partitions and rollup buckets older than the retention policy of every series.
+   *
+   * The caller must not hold the files lock or the mutex.
+   */
+  void enforceRetention();
+
+  /**
+   * @brief Removes partitions of a series that hold only records older than a timestamp.
+   *
+   * The caller must not hold the files lock or the mutex.
+   *
+   * @param series
+   *   Name of the component
+   * @param timestamp
+   *   Oldest timestamp to keep
+   *
+   * @return long long
+   *   Start of the oldest kept partition, or LLONG_MIN if nothing was removed
+   */
+  long long dropPartitions(const std::string& series, long long timestamp);
+
+  /**
+   * @brief Writes frozen memtables as runs.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex.
+   */
+  void flushFrozen();
+
+  /**
+   * @brief Writes all memtables as runs and empties the write-ahead log.
+   *
+   * The caller must hold the files lock exclusively and the mutex.
+   */
+  void checkpointLocked();
+
+  /**
+   * @brief Merges all runs of a series into its partitions.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex.
+   *
+   * @param series
+   *   Name of the component
+   */
+  void compact(const std::string& series);
+
+  /**
+   * @brief Deletes the oldest or newest records of every part of a series.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex; the memtables
+   * must have been written out.
+   *
+   * @param series
+   *   Name of the component
+   * @param state
+   *   Parts of the series, updated to the new state
+   * @param removed
+   *   Number of records to delete from the partitions, followed by one count per run
+   * @param fromStart
+   *   True to delete the oldest records, false to delete the newest ones
+   */
+  void applyRemoval(const std::string& series, SeriesState& state,
+                    const std::vector<size_t>& removed, bool fromStart);
+
+  /**
+   * @brief Writes a tombstone of a series and refreshes the rollups it touched.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex.
+   *
+   * @param series
+   *   Name of the component
+   * @param tombstone
+   *   Deleted records
+   *
+   * @throws std::runtime_error
+   *   If the tombstones cannot be written
+   */
+  void addTombstone(const std::string& series, const Tombstone& tombstone);
+
+  /**
+   * @brief Writes the memtables out and captures the parts of a series together with the newest
+   * log sequence number stored in it, which a tombstone of the captured records covers.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex.
+   *
+   * @param series
+   *   Name of the component
+   * @param lsn
+   *   Receives the newest log sequence number stored in the series
+   *
+   * @return SeriesState
+   *   Partitions, runs and tombstones of the series
+   */
+  SeriesState captureForRemoval(const std::string& series, uint64_t& lsn);
+
+  /**
+   * @brief Physically removes records covered by tombstones from a series and drops them.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex.
+   *
+   * @param series
+   *   Name of the component
+   */
+  void purge(const std::string& series);
+
+  /**
+   * @brief Recomputes the rollups of a series after records between two timestamps were deleted.
+   *
+   * Buckets within the hours spanned by the timestamps are rebuilt from the remaining records.
+   * The caller must hold the files lock exclusively and the mutex.
+   *
+   * @param series
+   *   Name of the component
+   * @param first
+   *   Oldest deleted timestamp
+   * @param last
+   *   Newest deleted timestamp
+   */
+  void refreshRollups(const std::string& series, long long first, long long last);
+
+  /**
+   * @brief Captures the parts of a series.
+   *
+   * The caller must hold the mutex.
+   *
+   * @param series
+   *   Name of the component
+   *
+   * @return SeriesState
+   *   Partitions, runs, buffered records and tombstones of the series
+   */
+  SeriesState getState(const std::string& series) const;
+
+  /**
+   * @brief Reads the records of every part of a series that can belong to its oldest or newest
+   * records.
+   *
+   * The caller must hold the files lock. The partitions form the first part, followed by the
+   * runs from the oldest and the buffered records.
+   *
+   * @param series
+   *   Name of the component
+   * @param state
+   *   Parts of the series
+   * @param count
+   *   Number of records needed, 0 or less for all records
+   * @param fromStart
+   *   True for the oldest records, false for the newest ones
+   *
+   * @return std::vector<std::vector<Measurement>>
+   *   Records of every part, each ordered by timestamp
+   */
+  std::vector<std::vector<Measurement>> collectParts(const std::string& series,
+                                                     const SeriesState& state, int count,
+                                                     bool fromStart) const;
+
+  /**
+   * @brief Reads the oldest or newest live records of a series.
+   *
+   * The caller must hold the files lock.
+   *
+   * @param series
+   *   Name of the component
+   * @param state
+   *   Parts of the series
+   * @param count
+   *   Number of records to read, 0 or less for all records
+   * @param fromStart
+   *   True to read the oldest records, false to read the newest ones
+   *
+   * @return std::vector<Measurement>
+   *   Records ordered by timestamp
+   */
+  std::vector<Measurement> collectLive(const std::string& series, const SeriesState& state,
+                                       int count, bool fromStart) const;
+
+  /**
+   * @brief Reads live records of a series with timestamps in the range [begin, end) and
+   * temperatures within [low, high].
+   *
+   * The caller must hold the files lock. Only the partitions overlapping the range are opened,
+   * and their chunks are skipped by zone when they cannot match.
+   *
+   * @param series
+   *   Name of the component
+   * @param state
+   *   Parts of the series
+   * @param begin
+   *   First timestamp of the range
+   * @param end
+   *   Timestamp one past the range
+   * @param low
+   *   Lowest matching temperature
+   * @param high
+   *   Highest matching temperature
+   *
+   * @return std::vector<Measurement>
+   *   Records ordered by timestamp
+   */
+  std::vector<Measurement>
+  collectRange(const std::string& series, const SeriesState& state, long long begin,
+               long long end, double low = -std::numeric_limits<double>::infinity(),
+               double high = std::numeric_limits<double>::infinity()) const;
+
+  /**
+   * @brief Drops the records hidden by tombstones from merged records of a series.
+   *
+   * Every timestamp must either be complete or, for the oldest one only, start with its first
+   * record, so that the sequence of each record is known.
+   *
+   * @param records
+   *   Records ordered by timestamp and, within a timestamp, by sequence
+   * @param lsns
+   *   Log sequence number of the part holding each record
+   * @param tombstones
+   *   Tombstones of the series
+   *
+   * @return std::vector<Measurement>
+   *   Live records, each carrying its sequence
+   */
+  static std::vector<Measurement> dropDeleted(const std::vector<Measurement>& records,
+                                              const std::vector<uint64_t>& lsns,
+                                              const std::vector<Tombstone>& tombstones);
+
+  /**
+   * @brief Checks whether a record is hidden by one of the tombstones.
+   *
+   * @param tombstones
+   *   Tombstones of the series
+   * @param timestamp
+   *   Timestamp of the record
+   * @param sequence
+   *   Sequence of the record among the records of its timestamp
+   * @param lsn
+   *   Log sequence number of the part holding the record
+   *
+   * @return bool
+   *   True if the record is deleted
+   */
+  static bool isDeleted(const std::vector<Tombstone>& tombstones, long long timestamp,
+                        size_t sequence, uint64_t lsn);
+
+  /**
+   * @brief Gets the log sequence number every part of a series is compared with by tombstones.
+   *
+   * Partitions only hold records older than every tombstone and count as 0, runs count with the
+   * newest number they hold, and buffered records are newer than every tombstone.
+   *
+   * @param state
+   *   Parts of the series
+   *
+   * @return std::vector<uint64_t>
+   *   Number of every part, laid out as by collectParts()
+   */
+  static std::vector<uint64_t> getPartLsns(const SeriesState& state);
+
+  /**
+   * @brief Durably writes the manifest.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex.
+   *
+   * @throws std::runtime_error
+   *   If the manifest cannot be written
+   */
+  void saveManifest();
+
+  /**
+   * @brief Durably writes the tombstones.
+   *
+   * The caller must hold the files lock exclusively and must not hold the mutex.
+   *
+   * @throws std::runtime_error
+   *   If the tombstones cannot be written
+   */
+  void saveTombstones();
+
+  /**
+   * @brief Loads the tombstones written by saveTombstones().
+   *
+   * @throws std::runtime_error
+   *   If the tombstones file exists but is unreadable
+   */
+  void loadTombstones();
+
+  /**
+   * @brief Gets segment name of a run.
+   *
+   * @param series
+   *   Name of the component
+   * @param lsn
+   *   Newest log sequence number of the run
+   *
+   * @return std::string
+   *   Name of the run segment
+   */
+  static std::string getRunName(const std::string& series, uint64_t lsn);
+
+  /**
+   * @brief Gets the partition holding a timestamp.
+   *
+   * @param timestamp
+   *   Timestamp of a record
+   *
+   * @return int64_t
+   *   First timestamp of the partition
+   */
+  static int64_t getPartition(long long timestamp);
+
+  /**
+   * @brief Gets path to the manifest.
+   *
+   * @return std::string
+   *   Full path to the manifest
+   */
+  std::string getManifestPath() const;
+
+  /**
+   * @brief Gets path to the tombstones file.
+   *
+   * @return std::string
+   *   Full path to the tombstones file
+   */
+  std::string getTombstonesPath() const;
+
+  std::mutex mutex;
+  std::shared_mutex filesMutex;
+  std::condition_variable workCv;
+  std::unordered_map<std::string, MemTable> memtables;
+  std::vector<std::pair<std::string, MemTable>> frozen;
+  std::map<std::string, std::vector<Run>> runs;
+  std::unordered_map<std::string, std::map<int64_t, size_t>> partitions;
+  std::unordered_map<std::string, uint64_t> compactedLsn;
+  std::unordered_map<std::string, std::vector<Tombstone>> tombstones;
+  RollupStore rollups;
+  uint64_t rollupLsn;
+  std::unordered_map<std::string, Retention> retention;
+  bool stopping;
+  std::thread worker;
+
+  static constexpr const char* MANIFEST_FILENAME = "manifest.json";
+  static constexpr const char* TOMBSTONES_FILENAME = "tombstones.json";
+  static constexpr std::chrono::milliseconds MAINTENANCE_INTERVAL{1000};
+  static constexpr std::chrono::seconds RETENTION_INTERVAL{60};
+};
@@ -0,0 +1,220 @@
+#pragma once
+
+// Standard library headers
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
+// Project headers
+#include "storage/measurement.h"
+
+/**
+ * @brief When the write-ahead log forces written records to stable storage.
+ */
+enum class FsyncPolicy {
+  ALWAYS,   ///< Every record is fsynced before append() returns.
+  INTERVAL, ///< Records are batched and fsynced periodically.
+  OS        ///< Records are written before append() returns, flushing is left to the OS.
+};
+
+/**
+ * @brief Write-ahead log protecting records held in memory by the storage engine, with group
+ * commit.
+ *
+ * Records appended while a batch is being written are collected and committed together with a
+ * single write and a single fsync. Every record gets an increasing log sequence number (LSN).
+ * Once the caller has stored all logged records durably elsewhere it takes a checkpoint, which
+ * remembers the last LSN and empties the log; only records logged after it are replayed.
+ */
+class WriteAheadLog {
+public:
+  /**
+   * @brief Gets singleton instance of WriteAheadLog.
+   *
+   * @return WriteAheadLog&
+   *   Reference to the singleton instance
+   */
+  static WriteAheadLog& getInstance();
+
+  /**
+   * @brief Stops the flusher thread after committing all pending records.
+   */
+  ~WriteAheadLog();
+
+  /**
+   * @brief Appends a record to the log and waits until it is committed according to the policy.
+   *
+   * @param record
+   *   Measurement to log
+   *
+   * @return uint64_t
+   *   Log sequence number assigned to the record
+   *
+   * @throws std::runtime_error
+   *   If the log cannot be written
+   */
+  uint64_t append(const Measurement& record);
+
+  /**
+   * @brief Assigns a sequence number to a record and queues it for the flusher without waiting.
+   *
+   * Lets the caller order the log with its own state under its own lock and wait outside of it.
+   *
+   * @param record
+   *   Measurement to log
+   *
+   * @return uint64_t
+   *   Log sequence number assigned to the record
+   *
+   * @throws std::runtime_error
+   *   If the log is no longer writable
+   */
+  uint64_t enqueue(const Measurement& record);
+
+  /**
+   * @brief Waits until a queued record is committed according to the policy.
+   *
+   * @param lsn
+   *   Log sequence number returned by enqueue()
+   *
+   * @throws std::runtime_error
+   *   If the log cannot be written
+   */
+  void waitFor(uint64_t lsn);
+
+  /**
+   * @brief Writes and fsyncs all pending records regardless of the policy.
+   *
+   * @throws std::runtime_error
+   *   If the log cannot be written
+   */
+  void flush();
+
+  /**
+   * @brief Passes every intact record logged after the last checkpoint to a callback.
+   *
+   * @param apply
+   *   Called with the sequence number and the record, in log order
+   *
+   * @return size_t
+   *   Number of replayed records
+   */
+  size_t replay(const std::function<void(uint64_t, const Measurement&)>& apply);
+
+  /**
+   * @brief Records that every logged record is stored durably elsewhere and empties the log.
+   *
+   * The caller must make sure no record is appended while the checkpoint is taken.
+   *
+   * @throws std::runtime_error
+   *   If the log or the checkpoint cannot be written
+   */
+  void checkpoint();
+
+  /**
+   * @brief Checks whether the log has grown past CHECKPOINT_BYTES.
+   *
+   * @return bool
+   *   True if a checkpoint should be taken
+   */
+  bool needsCheckpoint();
+
+  /**
+   * @brief Gets content of the checkpoint file loaded at startup or written last.
+   *
+   * Checkpoints written by older versions also hold the sizes of the segment and chunk files,
+   * which the storage engine needs to migrate them.
+   *
+   * @return nlohmann::json
+   *   Checkpoint object, null if there is none
+   */
+  nlohmann::json getCheckpoint();
+
+  /**
+   * @brief Parses fsync policy name used in the configuration file.
+   *
+   * @param name
+   *   One of "always", "interval" or "os"
+   *
+   * @return FsyncPolicy
+   *   Parsed policy
+   *
+   * @throws std::invalid_argument
+   *   If the name is not a known policy
+   */
+  static FsyncPolicy parsePolicy(const std::string& name);
+
+private:
+  /**
+   * @brief Private constructor for singleton pattern.
+   */
+  WriteAheadLog();
+
+  /**
+   * @brief Reads the log file and passes every intact entry to a callback.
+   *
+   * @param visit
+   *   Called with the sequence number and the record of every entry
+   *
+   * @return uint64_t
+   *   Size of the intact part of the log in bytes
+   */
+  uint64_t scan(const std::function<void(uint64_t, const Measurement&)>& visit);
+
+  /**
+   * @brief Background loop writing pending batches to the log file.
+   */
+  void flusherLoop();
+
+  /**
+   * @brief Writes a batch to the log file.
+   *
+   * @param batch
+   *   Encoded records
+   * @param sync
+   *   True to fsync after writing
+   *
+   * @return bool
+   *   True on success
+   */
+  bool writeBatch(const std::string& batch, bool sync);
+
+  /**
+   * @brief Gets path to the directory holding the log and the checkpoint.
+   *
+   * @return std::string
+   *   Full path to the WAL directory
+   */
+  std::string getWalDirectory() const;
+
+  int fd;
+  FsyncPolicy policy;
+  std::chrono::milliseconds interval;
+  uint64_t logSize;
+  nlohmann::json checkpointState;
+  uint64_t checkpointLsn;
+
+  std::mutex mutex;
+  std::condition_variable pendingCv;
+  std::condition_variable committedCv;
+  std::string pending;
+  uint64_t nextLsn;
+  uint64_t writtenLsn;
+  uint64_t durableLsn;
+  bool flushRequested;
+  bool stopping;
+  bool failed;
+  std::thread flusher;
+
+  static constexpr const char* WAL_DIRNAME = "wal";
+  static constexpr const char* LOG_FILENAME = "wal.log";
+  static constexpr const char* CHECKPOINT_FILENAME = "checkpoint.json";
+  static constexpr uint64_t CHECKPOINT_BYTES = 1 << 20;
+};
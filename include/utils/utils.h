@@ -1,6 +1,7 @@
 #pragma once
 
 // Standard library headers
+#include <cstdint>
 #include <string>
 
 /**
@@ -17,4 +18,32 @@ std::string getDataDirectory();
  * @param dataPath
  *   Path where the directory should be created
  */
-void ensureDataDirectoryExists(const std::string& dataPath);
\ No newline at end of file
+void ensureDataDirectoryExists(const std::string& dataPath);
+
+/**
+ * @brief Computes CRC-32 checksum of a byte range.
+ *
+ * @param data
+ *   Pointer to the first byte
+ * @param size
+ *   Number of bytes
+ *
+ * @return uint32_t
+ *   CRC-32 (IEEE) of the range
+ */
+uint32_t computeChecksum(const char* data, size_t size);
+
+/**
+ * @brief Writes a small file so that it either fully replaces the old one or not at all.
+ *
+ * The content goes to a temporary file which is fsynced and renamed over the destination.
+ *
+ * @param path
+ *   Destination path
+ * @param content
+ *   New file content
+ *
+ * @throws std::runtime_error
+ *   If the file cannot be written
+ */
+void writeFileDurably(const std::string& path, const std::string& content);
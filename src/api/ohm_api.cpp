@@ -32,36 +32,104 @@ size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* out
 }
 
 /**
- * Fetches JSON data from Open Hardware Monitor.
- *
- * @param url
- *   The OHM endpoint URL.
+ * @brief Gets the singleton instance of OHMFetcher.
  *
- * @return
- *   The JSON response as a string.
+ * @return OHMFetcher&
+ *   Reference to the singleton instance
  */
-std::string fetchOHMData(const std::string& url) {
-  CURL* curl;
-  CURLcode res;
-  std::string response;
+OHMFetcher& OHMFetcher::getInstance() {
+  static OHMFetcher instance;
+
+  return instance;
+}
+
+/**
+ * @brief Creates the cURL handle and reserves the response buffer.
+ */
+OHMFetcher::OHMFetcher() : curl(curl_easy_init()) {
+  response.reserve(RESPONSE_RESERVE);
 
-  curl = curl_easy_init();
   if (curl) {
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  }
+}
 
-    res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-      cerr << "cURL error: " << curl_easy_strerror(res) << endl;
-    }
-
+/**
+ * @brief Releases the cURL handle, closing its connection.
+ */
+OHMFetcher::~OHMFetcher() {
+  if (curl) {
     curl_easy_cleanup(curl);
   }
-  else {
+}
+
+/**
+ * @brief Fetches a document, reusing the connection of the previous request when the server kept
+ * it open.
+ *
+ * @param url
+ *   The OHM endpoint URL
+ *
+ * @return const std::string&
+ *   The response body, empty on failure; valid until the next call
+ */
+const std::string& OHMFetcher::fetch(const std::string& url) {
+  response.clear();
+  lastTiming = FetchTiming{};
+
+  if (!curl) {
     cerr << "cURL initialization failed\n";
+
+    return response;
+  }
+
+  curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+  CURLcode res = curl_easy_perform(curl);
+
+  curl_off_t time;
+  if (curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &time) == CURLE_OK) {
+    lastTiming.dns = time;
+  }
+  if (curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &time) == CURLE_OK) {
+    lastTiming.connect = time;
+  }
+  if (curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &time) == CURLE_OK) {
+    lastTiming.firstByte = time;
+  }
+  if (curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &time) == CURLE_OK) {
+    lastTiming.total = time;
+  }
+
+  if (res != CURLE_OK) {
+    cerr << "cURL error: " << curl_easy_strerror(res) << endl;
+    response.clear();
   }
 
   return response;
 }
+
+/**
+ * @brief Gets the timing of the last request.
+ *
+ * @return FetchTiming
+ *   Phases of the last request
+ */
+FetchTiming OHMFetcher::getLastTiming() const {
+  return lastTiming;
+}
+
+/**
+ * Fetches JSON data from Open Hardware Monitor.
+ *
+ * @param url
+ *   The OHM endpoint URL.
+ *
+ * @return
+ *   The JSON response as a string.
+ */
+std::string fetchOHMData(const std::string& url) {
+  return OHMFetcher::getInstance().fetch(url);
+}
@@ -1,3 +1,6 @@
+// Standard library headers
+#include <utility>
+
 // Project headers
 #include "api/ohm_data.h"
 #include "config/config_loader.h"
@@ -7,9 +10,12 @@
  *
  * @param data
  *   JSON data from OpenHardwareMonitor containing sensor readings
+ * @param paths
+ *   Sensor paths of the machine, reused and filled by the lookups; nullptr to search the tree on
+ *   every lookup
  */
-OHMData::OHMData(const nlohmann::json& data)
-    : rawData(data), timestamp(std::chrono::system_clock::now()) {
+OHMData::OHMData(nlohmann::json data, SensorPaths* paths)
+    : rawData(std::move(data)), timestamp(std::chrono::system_clock::now()), paths(paths) {
 }
 
 /**
@@ -19,7 +25,7 @@ OHMData::OHMData(const nlohmann::json& data)
  *   GPU temperature in Celsius, -1.0 if not found
  */
 double OHMData::getGPUTemperature() const {
-  return findComponent(ConfigLoader::GPU, "GPU Core");
+  return lookup({ConfigLoader::GPU}, "GPU Core");
 }
 
 /**
@@ -29,7 +35,7 @@ double OHMData::getGPUTemperature() const {
  *   CPU temperature in Celsius, -1.0 if not found
  */
 double OHMData::getCPUTemperature() const {
-  return findComponent(ConfigLoader::CPU, "CPU Package");
+  return lookup({ConfigLoader::CPU}, "CPU Package");
 }
 
 /**
@@ -39,12 +45,15 @@ double OHMData::getCPUTemperature() const {
  *   Motherboard temperature in Celsius, -1.0 if not found
  */
 double OHMData::getMotherboardTemperature() const {
-  return findMotherboardTemperature();
+  return lookup({ConfigLoader::MOTHERBOARD, "Nuvoton"}, "CPU Core");
 }
 
 /**
  * @brief Gets current timestamp in Unix format.
  *
+ * The timestamp is truncated to whole seconds, so sub-second samples are ordered by their
+ * sequence in the storage engine rather than by timestamp.
+ *
  * @return long long
  *   Unix timestamp in seconds
  */
@@ -53,67 +62,155 @@ long long OHMData::getTimestamp() const {
 }
 
 /**
- * @brief Finds temperature for specific device in JSON data.
+ * @brief Reads a temperature through a cached path, or resolves and caches its path.
  *
- * @param deviceIdentifier
- *   String to identify device (e.g., "NVIDIA", "Intel")
+ * A cached path is validated on the way down, so a changed tree falls back to a full search.
+ *
+ * @param identifiers
+ *   Strings the device nodes along the path must contain, from the outermost one
  * @param sensorName
  *   Name of the temperature sensor to read
  *
  * @return double
  *   Temperature in Celsius, -1.0 if not found
  */
-double OHMData::findComponent(const std::string& deviceIdentifier,
-                              const std::string& sensorName) const {
-  if (!rawData.contains("Children") || !rawData["Children"].is_array()) {
+double OHMData::lookup(const std::vector<std::string>& identifiers,
+                       const std::string& sensorName) const {
+  std::string key;
+  for (const auto& identifier : identifiers) {
+    key += identifier + '\n';
+  }
+  key += sensorName;
+
+  if (paths) {
+    auto it = paths->find(key);
+    if (it != paths->end()) {
+      double temperature = readPath(it->second, identifiers, sensorName);
+      if (temperature != -1.0) {
+        return temperature;
+      }
+      paths->erase(it);
+    }
+  }
+
+  std::vector<size_t> path;
+  double temperature = resolve(identifiers, sensorName, path);
+  if (paths && temperature != -1.0) {
+    (*paths)[key] = std::move(path);
+  }
+
+  return temperature;
+}
+
+/**
+ * @brief Follows a path and reads the sensor it ends at.
+ *
+ * The path runs through a top-level node, one device node per identifier, the "Temperatures"
+ * category and the sensor; every node on it is checked against what it must be.
+ *
+ * @param path
+ *   Child indices from the root to the sensor
+ * @param identifiers
+ *   Strings the device nodes along the path must contain, from the outermost one
+ * @param sensorName
+ *   Name of the temperature sensor to read
+ *
+ * @return double
+ *   Temperature in Celsius, -1.0 if the path does not lead to the sensor any more
+ */
+double OHMData::readPath(const std::vector<size_t>& path,
+                         const std::vector<std::string>& identifiers,
+                         const std::string& sensorName) const {
+  if (path.size() != identifiers.size() + 3) {
     return -1.0;
   }
 
-  for (const auto& systemNode : rawData["Children"]) {
-    if (!systemNode.contains("Children"))
+  const nlohmann::json* node = &rawData;
+  for (size_t depth = 0; depth < path.size(); ++depth) {
+    if (!node->is_object() || !node->contains("Children")) {
+      return -1.0;
+    }
+    const auto& children = (*node)["Children"];
+    if (!children.is_array() || path[depth] >= children.size()) {
+      return -1.0;
+    }
+    node = &children[path[depth]];
+    if (depth == 0) {
       continue;
+    }
 
-    for (const auto& motherboardNode : systemNode["Children"]) {
-      if (!motherboardNode.contains("Text") || !motherboardNode.contains("Children"))
-        continue;
-
-      std::string deviceName = motherboardNode["Text"].get<std::string>();
-      if (deviceName.find(deviceIdentifier) != std::string::npos) {
-        return findTemperature(motherboardNode, sensorName);
+    if (!node->is_object() || !node->contains("Text") || !(*node)["Text"].is_string()) {
+      return -1.0;
+    }
+    const auto& text = (*node)["Text"].get_ref<const std::string&>();
+    if (depth <= identifiers.size()) {
+      if (text.find(identifiers[depth - 1]) == std::string::npos) {
+        return -1.0;
+      }
+    }
+    else if (depth == identifiers.size() + 1) {
+      if (text != "Temperatures") {
+        return -1.0;
       }
     }
+    else if (text != sensorName || !node->contains("Value")) {
+      return -1.0;
+    }
   }
 
-  return -1.0;
+  return parseValue(*node);
 }
 
 /**
- * @brief Finds motherboard temperature in JSON data.
+ * @brief Searches the tree for a temperature sensor.
+ *
+ * Descends from every top-level node through the first child whose name contains each
+ * identifier in turn, then reads the sensor from the device reached.
+ *
+ * @param identifiers
+ *   Strings identifying the device nodes, from the outermost one (e.g., "MSI", "Nuvoton")
+ * @param sensorName
+ *   Name of the temperature sensor to read
+ * @param path
+ *   Receives the child indices from the root to the sensor
  *
  * @return double
- *   Motherboard temperature in Celsius, -1.0 if not found
+ *   Temperature in Celsius, -1.0 if not found
  */
-double OHMData::findMotherboardTemperature() const {
+double OHMData::resolve(const std::vector<std::string>& identifiers,
+                        const std::string& sensorName, std::vector<size_t>& path) const {
   if (!rawData.contains("Children") || !rawData["Children"].is_array()) {
     return -1.0;
   }
 
-  for (const auto& systemNode : rawData["Children"]) {
-    if (!systemNode.contains("Children"))
-      continue;
-
-    for (const auto& motherboardNode : systemNode["Children"]) {
-      if (!motherboardNode.contains("Text") || !motherboardNode.contains("Children"))
-        continue;
+  const auto& systemNodes = rawData["Children"];
+  for (size_t system = 0; system < systemNodes.size(); ++system) {
+    const nlohmann::json* node = &systemNodes[system];
+    path.assign(1, system);
 
-      std::string deviceName = motherboardNode["Text"].get<std::string>();
-      if (deviceName.find(ConfigLoader::MOTHERBOARD) != std::string::npos) {
-        for (const auto& chipNode : motherboardNode["Children"]) {
-          if (chipNode["Text"].get<std::string>().find("Nuvoton") != std::string::npos) {
-            return findTemperature(chipNode, "CPU Core");
+    for (const auto& identifier : identifiers) {
+      const nlohmann::json* match = nullptr;
+      if (node->contains("Children") && (*node)["Children"].is_array()) {
+        const auto& children = (*node)["Children"];
+        for (size_t i = 0; i < children.size(); ++i) {
+          const auto& child = children[i];
+          if (child.contains("Text") && child.contains("Children") &&
+              child["Text"].get<std::string>().find(identifier) != std::string::npos) {
+            match = &child;
+            path.push_back(i);
+            break;
           }
         }
       }
+
+      node = match;
+      if (!node) {
+        break;
+      }
+    }
+
+    if (node) {
+      return findTemperature(*node, sensorName, path);
     }
   }
 
@@ -127,23 +224,46 @@ double OHMData::findMotherboardTemperature() const {
  *   JSON object containing device sensor data
  * @param sensorName
  *   Name of the temperature sensor to read
+ * @param path
+ *   Receives the indices of the sensor category and of the sensor
  *
  * @return double
  *   Temperature in Celsius, -1.0 if not found
  */
-double OHMData::findTemperature(const nlohmann::json& device, const std::string& sensorName) const {
-  for (const auto& sensorCategory : device["Children"]) {
+double OHMData::findTemperature(const nlohmann::json& device, const std::string& sensorName,
+                                std::vector<size_t>& path) const {
+  const auto& categories = device["Children"];
+  for (size_t category = 0; category < categories.size(); ++category) {
+    const auto& sensorCategory = categories[category];
     if (sensorCategory.contains("Text") && sensorCategory["Text"] == "Temperatures") {
-      for (const auto& sensor : sensorCategory["Children"]) {
+      const auto& sensors = sensorCategory["Children"];
+      for (size_t i = 0; i < sensors.size(); ++i) {
+        const auto& sensor = sensors[i];
         if (sensor.contains("Text") && sensor["Text"] == sensorName && sensor.contains("Value")) {
-          std::string valueStr = sensor["Value"].get<std::string>();
-          valueStr.erase(valueStr.find(" °C"), 3);
+          path.push_back(category);
+          path.push_back(i);
 
-          return std::stod(valueStr);
+          return parseValue(sensor);
         }
       }
     }
   }
 
   return -1.0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Parses the value of a temperature sensor.
+ *
+ * @param sensor
+ *   JSON object of the sensor
+ *
+ * @return double
+ *   Temperature in Celsius
+ */
+double OHMData::parseValue(const nlohmann::json& sensor) {
+  std::string valueStr = sensor["Value"].get<std::string>();
+  valueStr.erase(valueStr.find(" °C"), 3);
+
+  return std::stod(valueStr);
+}
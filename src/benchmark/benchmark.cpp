@@ -1,5 +1,6 @@
 // Standard library headers
 #include <chrono>
+#include <cstring>
 #include <iostream>
 #include <thread>
 
@@ -7,9 +8,12 @@
 #include "api/ohm_api.h"
 #include "api/ohm_data.h"
 #include "benchmark/benchmark.h"
+#include "benchmark/bson_storage.h"
 #include "benchmark/sqlite_storage.h"
 #include "config/config.h"
 #include "inputs/file_source.h"
+#include "storage/chunk_store.h"
+#include "storage/gorilla.h"
 #include "storage/index_manager.h"
 #include "storage/storage.h"
 
@@ -49,7 +53,9 @@ static Measurement getMeasurementFromOHM(const string& component) {
 }
 
 /**
- * @brief Benchmarks saving measurements to JSON storage.
+ * @brief Benchmarks saving measurements through the storage engine.
+ *
+ * Only saving is timed; the measurements are fetched from OHM beforehand.
  *
  * @param components
  *   List of component names to record
@@ -61,23 +67,24 @@ static Measurement getMeasurementFromOHM(const string& component) {
  * @return long long
  *   Total time spent saving in microseconds
  */
-long long benchmarkSaveJson(const vector<string>& components, int numRecords, int interval) {
-  cout << "\n=== JSON Save Benchmark ===\n";
+long long benchmarkSaveEngine(const vector<string>& components, int numRecords, int interval) {
+  cout << "\n=== Storage Engine Save Benchmark ===\n";
   StorageManager storage;
   long long total = 0;
 
   for (int i = 0; i < numRecords; ++i) {
-    cout << "Saving JSON batch " << (i + 1) << "/" << numRecords << "...\n";
+    cout << "Saving storage engine batch " << (i + 1) << "/" << numRecords << "...\n";
     for (auto& comp : components) {
-      auto t0 = high_resolution_clock::now();
+      Measurement m;
       try {
-        auto m = getMeasurementFromOHM(comp);
-        storage.saveRecord(m);
+        m = getMeasurementFromOHM(comp);
       }
       catch (exception& e) {
         cout << "Error: " << e.what() << "\n";
         continue;
       }
+      auto t0 = high_resolution_clock::now();
+      storage.saveRecord(m);
       auto t1 = high_resolution_clock::now();
       long long dt = duration_cast<microseconds>(t1 - t0).count();
       total += dt;
@@ -90,7 +97,7 @@ long long benchmarkSaveJson(const vector<string>& components, int numRecords, in
 }
 
 /**
- * @brief Benchmarks reading measurements from JSON storage.
+ * @brief Benchmarks reading measurements through the storage engine.
  *
  * @param components
  *   List of component names to read
@@ -100,25 +107,103 @@ long long benchmarkSaveJson(const vector<string>& components, int numRecords, in
  *   Delay in seconds between reading different components (0 for no delay)
  *
  * @return long long
- *   Total time spent reading in milliseconds
+ *   Total time spent reading in microseconds
  */
-long long benchmarkReadJson(const std::vector<std::string>& components, int numRecords,
-                            int interval) {
-  cout << "\n=== JSON Read Benchmark ===\n";
+long long benchmarkReadEngine(const std::vector<std::string>& components, int numRecords,
+                              int interval) {
+  cout << "\n=== Storage Engine Read Benchmark ===\n";
   long long total = 0;
   FileSource src;
 
   for (const auto& comp : components) {
-    cout << "Reading JSON batch for " << comp << " (" << numRecords << " records)...\n";
+    cout << "Reading storage engine batch for " << comp << " (" << numRecords << " records)...\n";
 
     auto t0 = high_resolution_clock::now();
     auto recs = src.getMeasurements(comp, numRecords, false);
     auto t1 = high_resolution_clock::now();
 
-    long long dt = duration_cast<milliseconds>(t1 - t0).count();
+    long long dt = duration_cast<microseconds>(t1 - t0).count();
     total += dt;
 
-    cout << "Read " << recs.size() << " records for " << comp << " in " << dt << " ms\n";
+    cout << "Read " << recs.size() << " records for " << comp << " in " << dt << " µs\n";
+
+    for (const auto& m : recs) {
+      cout << " - Temp: " << m.temperature << "°C"
+           << ", Timestamp: " << m.timestamp << "\n";
+    }
+
+    if (interval > 0)
+      this_thread::sleep_for(seconds(interval));
+  }
+
+  return total;
+}
+
+/**
+ * @brief Benchmarks saving measurements to BSON files.
+ *
+ * @param components
+ *   List of component names to record
+ * @param numRecords
+ *   Number of batches (each batch writes one record per component)
+ * @param interval
+ *   Delay in seconds between batches (0 for no delay)
+ *
+ * @return long long
+ *   Total time spent saving in microseconds
+ */
+long long benchmarkSaveBson(const vector<string>& components, int numRecords, int interval) {
+  cout << "\n=== BSON Save Benchmark ===\n";
+  BSONStorageManager bson;
+  long long total = 0;
+
+  for (int i = 0; i < numRecords; ++i) {
+    cout << "Saving BSON batch " << (i + 1) << "/" << numRecords << "...\n";
+    for (auto& comp : components) {
+      auto m = getMeasurementFromOHM(comp);
+      auto t0 = high_resolution_clock::now();
+      bson.saveRecord(m);
+      auto t1 = high_resolution_clock::now();
+      long long dt = duration_cast<microseconds>(t1 - t0).count();
+      total += dt;
+      cout << "Record for " << comp << " saved in " << dt << " µs\n";
+    }
+    if (interval > 0)
+      this_thread::sleep_for(seconds(interval));
+  }
+  return total;
+}
+
+/**
+ * @brief Benchmarks reading measurements from BSON files.
+ *
+ * @param components
+ *   List of component names to read
+ * @param numRecords
+ *   Maximum number of records to read per component (0 for all)
+ * @param interval
+ *   Delay in seconds between reading different components (0 for no delay)
+ *
+ * @return long long
+ *   Total time spent reading in microseconds
+ */
+long long benchmarkReadBson(const std::vector<std::string>& components, int numRecords,
+                            int interval) {
+  cout << "\n=== BSON Read Benchmark ===\n";
+  BSONStorageManager bson;
+  long long total = 0;
+
+  for (const auto& comp : components) {
+    cout << "Reading BSON batch for " << comp << " (" << numRecords << " records)...\n";
+
+    auto t0 = high_resolution_clock::now();
+    auto recs = bson.loadRecords(comp, numRecords);
+    auto t1 = high_resolution_clock::now();
+
+    long long dt = duration_cast<microseconds>(t1 - t0).count();
+    total += dt;
+
+    cout << "Read " << recs.size() << " records for " << comp << " in " << dt << " µs\n";
 
     for (const auto& m : recs) {
       cout << " - Temp: " << m.temperature << "°C"
@@ -178,7 +263,7 @@ long long benchmarkSaveSqlite(const vector<string>& components, int numRecords,
  *   Delay in seconds between reading different components (0 for no delay)
  *
  * @return long long
- *   Total time spent reading in milliseconds
+ *   Total time spent reading in microseconds
  */
 long long benchmarkReadSqlite(const std::vector<std::string>& components, int numRecords,
                               int interval) {
@@ -193,10 +278,10 @@ long long benchmarkReadSqlite(const std::vector<std::string>& components, int nu
     auto recs = sqlite.loadRecords(comp, numRecords);
     auto t1 = high_resolution_clock::now();
 
-    long long dt = duration_cast<milliseconds>(t1 - t0).count();
+    long long dt = duration_cast<microseconds>(t1 - t0).count();
     total += dt;
 
-    cout << "Read " << recs.size() << " records for " << comp << " in " << dt << " ms\n";
+    cout << "Read " << recs.size() << " records for " << comp << " in " << dt << " µs\n";
 
     for (const auto& m : recs) {
       cout << " - Temp: " << m.temperature << "°C"
@@ -211,7 +296,91 @@ long long benchmarkReadSqlite(const std::vector<std::string>& components, int nu
 }
 
 /**
- * @brief Runs all benchmarks (JSON save/read and SQLite save/read) and prints a summary.
+ * @brief Compares size and scan speed of JSON records, BSON documents and Gorilla-compressed
+ * chunks.
+ *
+ * @param components
+ *   List of component names to compare
+ */
+void benchmarkCompression(const vector<string>& components) {
+  cout << "\n=== Compression Benchmark ===\n";
+  FileSource src;
+
+  for (const auto& comp : components) {
+    vector<Measurement> recs;
+    try {
+      recs = src.getMeasurements(comp, 0, true);
+    }
+    catch (exception& e) {
+      cout << "Skipping " << comp << ": " << e.what() << "\n";
+      continue;
+    }
+
+    nlohmann::json array = nlohmann::json::array();
+    for (const auto& m : recs) {
+      array.push_back({{"Component", m.component},
+                       {"Temperature", m.temperature},
+                       {"Timestamp", m.timestamp}});
+    }
+    string json = array.dump(4);
+    string chunks = ChunkStore::encode(recs);
+    vector<uint8_t> bson;
+    for (const auto& rec : array) {
+      vector<uint8_t> document = nlohmann::json::to_bson(rec);
+      bson.insert(bson.end(), document.begin(), document.end());
+    }
+
+    auto t0 = high_resolution_clock::now();
+    vector<Measurement> fromJson;
+    for (const auto& rec : nlohmann::json::parse(json)) {
+      fromJson.push_back({rec["Component"], rec["Temperature"], rec["Timestamp"]});
+    }
+    auto t1 = high_resolution_clock::now();
+
+    vector<Measurement> fromChunks;
+    for (size_t offset = 0; offset < chunks.size();) {
+      ChunkHeader header;
+      memcpy(&header, chunks.data() + offset, sizeof(header));
+      GorillaDecoder decoder(chunks.data() + offset + sizeof(header), header.payloadSize,
+                             header.count);
+      int64_t timestamp;
+      double temperature;
+      while (decoder.next(timestamp, temperature)) {
+        fromChunks.push_back({comp, temperature, timestamp});
+      }
+      offset += sizeof(header) + header.payloadSize + sizeof(uint32_t);
+    }
+    auto t2 = high_resolution_clock::now();
+
+    vector<Measurement> fromBson;
+    for (size_t offset = 0; offset < bson.size();) {
+      int32_t length;
+      memcpy(&length, bson.data() + offset, sizeof(length));
+      auto rec = nlohmann::json::from_bson(bson.begin() + offset, bson.begin() + offset + length);
+      fromBson.push_back({rec["Component"], rec["Temperature"], rec["Timestamp"]});
+      offset += length;
+    }
+    auto t3 = high_resolution_clock::now();
+
+    long long jsonUs = duration_cast<microseconds>(t1 - t0).count();
+    long long chunkUs = duration_cast<microseconds>(t2 - t1).count();
+    long long bsonUs = duration_cast<microseconds>(t3 - t2).count();
+    cout << comp << " (" << recs.size() << " records):\n";
+    cout << " - JSON:   " << json.size() << " bytes, "
+         << (json.size() / double(recs.size())) << " B/rec, scan = " << jsonUs << " µs\n";
+    cout << " - BSON:   " << bson.size() << " bytes, "
+         << (bson.size() / double(recs.size())) << " B/rec, scan = " << bsonUs << " µs\n";
+    cout << " - Chunks: " << chunks.size() << " bytes, "
+         << (chunks.size() / double(recs.size())) << " B/rec, scan = " << chunkUs << " µs\n";
+    if (fromChunks.size() != fromJson.size()) {
+      cout << " - Warning: decoded " << fromChunks.size() << " of " << fromJson.size()
+           << " records\n";
+    }
+  }
+}
+
+/**
+ * @brief Runs all benchmarks (storage engine, BSON and SQLite save/read) and prints a summary.
  */
 void runBenchmark() {
   vector<string> components = {"CPU", "GPU", "Motherboard"};
@@ -222,19 +391,27 @@ void runBenchmark() {
   cout << "Enter interval (s): ";
   cin >> interval;
 
-  auto totalJsonSave = benchmarkSaveJson(components, numRecords, interval);
-  auto totalJsonRead = benchmarkReadJson(components, numRecords, interval);
+  auto totalEngineSave = benchmarkSaveEngine(components, numRecords, interval);
+  auto totalEngineRead = benchmarkReadEngine(components, numRecords, interval);
+  auto totalBsonSave = benchmarkSaveBson(components, numRecords, interval);
+  auto totalBsonRead = benchmarkReadBson(components, numRecords, interval);
+  BSONStorageManager().clear();
   auto totalSqlSave = benchmarkSaveSqlite(components, numRecords, interval);
   auto totalSqlRead = benchmarkReadSqlite(components, numRecords, interval);
+  benchmarkCompression(components);
 
   int recCount = numRecords * components.size();
   cout << "\n--- Summary ---\n";
-  cout << "JSON:   total save = " << totalJsonSave
-       << " µs, avg = " << (totalJsonSave / double(recCount)) << " µs/rec\n";
-  cout << "JSON:   total read = " << totalJsonRead
-       << " ns, avg = " << (totalJsonRead / double(recCount)) << " ns/rec\n";
+  cout << "Engine: total save = " << totalEngineSave
+       << " µs, avg = " << (totalEngineSave / double(recCount)) << " µs/rec\n";
+  cout << "Engine: total read = " << totalEngineRead
+       << " µs, avg = " << (totalEngineRead / double(recCount)) << " µs/rec\n";
+  cout << "BSON:   total save = " << totalBsonSave
+       << " µs, avg = " << (totalBsonSave / double(recCount)) << " µs/rec\n";
+  cout << "BSON:   total read = " << totalBsonRead
+       << " µs, avg = " << (totalBsonRead / double(recCount)) << " µs/rec\n";
   cout << "SQLite: total save = " << totalSqlSave
        << " µs, avg = " << (totalSqlSave / double(recCount)) << " µs/rec\n";
   cout << "SQLite: total read = " << totalSqlRead
-       << " ns, avg = " << (totalSqlRead / double(recCount)) << " ns/rec\n";
+       << " µs, avg = " << (totalSqlRead / double(recCount)) << " µs/rec\n";
 }
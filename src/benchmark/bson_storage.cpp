@@ -0,0 +1,155 @@
+// Standard library headers
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
+// Project headers
+#include "benchmark/bson_storage.h"
+#include "storage/mapped_file.h"
+#include "utils/utils.h"
+
+/**
+ * @brief Constructs the BSONStorageManager and ensures its directory exists.
+ *
+ * The default directory is kept apart from the live data, so benchmark files never mix with the
+ * stored measurements.
+ *
+ * @param directory
+ *   Optional directory holding the BSON files. If empty, defaults to the benchmark directory.
+ */
+BSONStorageManager::BSONStorageManager(const std::string& directory)
+    : directory(directory.empty() ? getDataDirectory() + "/" + BENCHMARK_DIRECTORY : directory) {
+  if (directory.empty()) {
+    ensureDataDirectoryExists(getDataDirectory());
+  }
+  ensureDataDirectoryExists(this->directory);
+}
+
+/**
+ * @brief Encodes a measurement as a BSON document and appends it to the file of its component.
+ *
+ * @param m
+ *   The measurement containing component, temperature, and timestamp.
+ *
+ * @throws std::runtime_error
+ *   If the file cannot be opened or written.
+ */
+void BSONStorageManager::saveRecord(const Measurement& m) {
+  nlohmann::json document = {
+      {"Component", m.component}, {"Temperature", m.temperature}, {"Timestamp", m.timestamp}};
+  std::vector<std::uint8_t> bytes = nlohmann::json::to_bson(document);
+
+  std::ofstream file(getPath(m.component), std::ios::binary | std::ios::app);
+  if (!file) {
+    throw std::runtime_error("Cannot open file: " + getPath(m.component));
+  }
+  file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  if (!file) {
+    throw std::runtime_error("Cannot write file: " + getPath(m.component));
+  }
+}
+
+/**
+ * @brief Loads the most recent measurement records for a given component.
+ *
+ * The file is memory-mapped and walked by the size prefixes of the documents; only the last limit
+ * documents are parsed.
+ *
+ * @param component
+ *   The name of the component (e.g., "CPU", "GPU").
+ * @param limit
+ *   Maximum number of records to return, 0 or less for all records.
+ *
+ * @return std::vector<Measurement>
+ *   A vector of Measurement objects sorted by ascending timestamp.
+ *
+ * @throws std::runtime_error
+ *   If the file cannot be mapped or a document cannot be decoded.
+ */
+std::vector<Measurement> BSONStorageManager::loadRecords(const std::string& component,
+                                                         int limit) {
+  std::vector<Measurement> result;
+  struct stat info;
+  if (stat(getPath(component).c_str(), &info) != 0) {
+    return result;
+  }
+
+  MappedFile file(getPath(component));
+  const char* bytes = file.data();
+
+  std::vector<std::pair<size_t, size_t>> documents;
+  for (size_t offset = 0; offset + sizeof(int32_t) <= file.size();) {
+    int32_t length;
+    memcpy(&length, bytes + offset, sizeof(length));
+    if (length < 5 || offset + length > file.size()) {
+      break;
+    }
+    documents.emplace_back(offset, length);
+    offset += length;
+  }
+
+  size_t first = 0;
+  if (limit > 0 && documents.size() > static_cast<size_t>(limit)) {
+    first = documents.size() - limit;
+  }
+
+  for (size_t i = first; i < documents.size(); ++i) {
+    const auto* begin = reinterpret_cast<const std::uint8_t*>(bytes + documents[i].first);
+    try {
+      nlohmann::json document = nlohmann::json::from_bson(begin, begin + documents[i].second);
+      result.push_back({document["Component"].get<std::string>(),
+                        document["Temperature"].get<double>(),
+                        document["Timestamp"].get<long long>()});
+    }
+    catch (const nlohmann::json::exception& e) {
+      throw std::runtime_error("Corrupted BSON document in " + getPath(component) + ": " +
+                               e.what());
+    }
+  }
+
+  return result;
+}
+
+/**
+ * @brief Removes all BSON files and then the directory if it is left empty.
+ */
+void BSONStorageManager::clear() {
+  std::string extension = BSON_EXTENSION;
+
+  DIR* dir = opendir(directory.c_str());
+  if (!dir) {
+    return;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() > extension.size() &&
+        name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+      std::remove((directory + "/" + name).c_str());
+    }
+  }
+  closedir(dir);
+
+  rmdir(directory.c_str());
+}
+
+/**
+ * @brief Gets path to the BSON file of a component.
+ *
+ * @param component
+ *   The name of the component.
+ *
+ * @return std::string
+ *   Full path to the file.
+ */
+std::string BSONStorageManager::getPath(const std::string& component) const {
+  return directory + "/" + component + BSON_EXTENSION;
+}
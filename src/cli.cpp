@@ -1,13 +1,17 @@
 // Standard library headers
 #include <chrono>
+#include <ctime>
 #include <functional>
+#include <iomanip>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <sstream>
 #include <sys/select.h>
 #include <termios.h>
 #include <thread>
 #include <unistd.h>
+#include <vector>
 
 // Third-party libraries
 #include <nlohmann/json.hpp>
@@ -60,6 +64,120 @@ void clearInputBuffer() {
   cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
+/**
+ * @brief Parses a point in time entered by the user.
+ *
+ * @param input
+ *   Unix timestamp, or local time as "YYYY-MM-DD HH:MM" or "YYYY-MM-DD HH:MM:SS"
+ *
+ * @return long long
+ *   Unix timestamp
+ *
+ * @throws std::invalid_argument
+ *   If the input matches none of the formats
+ */
+long long parseTimestamp(const string& input) {
+  size_t digits = 0;
+  long long timestamp = 0;
+  try {
+    timestamp = stoll(input, &digits);
+  }
+  catch (const exception&) {
+    digits = 0;
+  }
+  if (digits > 0 && digits == input.size()) {
+    return timestamp;
+  }
+
+  for (const char* format : {"%Y-%m-%d %H:%M:%S", "%Y-%m-%d %H:%M"}) {
+    tm time = {};
+    istringstream stream(input);
+    stream >> get_time(&time, format);
+    if (!stream.fail() && (stream >> ws).eof()) {
+      time.tm_isdst = -1;
+
+      return mktime(&time);
+    }
+  }
+
+  throw invalid_argument("Invalid time: " + input);
+}
+
+/**
+ * @brief Prompts for the bounds of a time range.
+ *
+ * @param from
+ *   Receives the first timestamp of the range
+ * @param to
+ *   Receives the timestamp one past the range
+ *
+ * @return bool
+ *   False if the user entered an invalid or empty range
+ */
+bool readTimeRange(long long& from, long long& to) {
+  string input;
+  clearInputBuffer();
+  try {
+    cout << "From (YYYY-MM-DD HH:MM[:SS] or Unix timestamp): ";
+    getline(cin, input);
+    from = parseTimestamp(input);
+
+    cout << "To, exclusive (YYYY-MM-DD HH:MM[:SS] or Unix timestamp): ";
+    getline(cin, input);
+    to = parseTimestamp(input);
+  }
+  catch (const exception& e) {
+    cout << e.what() << "\n";
+
+    return false;
+  }
+
+  if (from >= to) {
+    cout << "Invalid range. The end must be later than the start.\n";
+
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Prompts for the bounds of a temperature interval; an empty bound leaves that side open.
+ *
+ * @param low
+ *   Receives the lowest matching temperature
+ * @param high
+ *   Receives the highest matching temperature
+ *
+ * @return bool
+ *   False if the user entered an invalid or empty interval
+ */
+bool readTemperatureBounds(double& low, double& high) {
+  string input;
+  try {
+    cout << "Lowest temperature in °C (empty for none): ";
+    getline(cin, input);
+    low = input.empty() ? -numeric_limits<double>::infinity() : stod(input);
+
+    cout << "Highest temperature in °C (empty for none): ";
+    getline(cin, input);
+    high = input.empty() ? numeric_limits<double>::infinity() : stod(input);
+  }
+  catch (const exception&) {
+    cout << "Invalid temperature: " << input << "\n";
+
+    return false;
+  }
+
+  if (low > high) {
+    cout << "Invalid interval. The highest temperature must not be below the lowest.\n";
+
+    return false;
+  }
+
+  return true;
+}
+
 /**
  * @brief Template function handling record operations.
  *
@@ -68,17 +186,39 @@ void clearInputBuffer() {
  * @param component
  *   Name of the hardware component being operated on
  * @param action
- *   Callback function to execute the operation
+ *   Callback function to execute the operation on a number of records
+ * @param rangeAction
+ *   Callback function to execute the operation on a time range
+ * @param olderAction
+ *   Callback function to execute the operation on records older than a point in time, or nullptr
+ *   if the operation does not offer it
+ * @param aggregateAction
+ *   Callback function to execute the operation on min/max/average buckets of a time range, or
+ *   nullptr if the operation does not offer it
+ * @param temperatureAction
+ *   Callback function to execute the operation on the records of a time range within a
+ *   temperature interval, or nullptr if the operation does not offer it
  *
  * @tparam ActionFunc
  *   Type of the callback function for operation execution
+ * @tparam RangeFunc
+ *   Type of the callback function for time range execution
  */
-template <typename ActionFunc>
-void handleRecords(const string& operationName, const string& component, ActionFunc action) {
+template <typename ActionFunc, typename RangeFunc>
+void handleRecords(
+    const string& operationName, const string& component, ActionFunc action, RangeFunc rangeAction,
+    function<void(const string&, long long)> olderAction,
+    function<void(const string&, long long, long long, long long)> aggregateAction = nullptr,
+    function<void(const string&, long long, long long, double, double)> temperatureAction =
+        nullptr) {
   string input;
   while (true) {
     cout << "\nEnter the number of records to " << operationName
-         << " (0 for all, 'exit' or 'e' to return): ";
+         << " (0 for all, 'r' for a time range, "
+         << (temperatureAction ? "'t' for a time range within temperature bounds, " : "")
+         << (olderAction ? "'o' for records older than a time, " : "")
+         << (aggregateAction ? "'a' for aggregates over a time range, " : "")
+         << "'exit' or 'e' to return): ";
     if (!(cin >> input)) {
       clearInputBuffer();
       cout << "Invalid input. Please enter a valid number or 'exit' or 'e'.\n";
@@ -91,6 +231,68 @@ void handleRecords(const string& operationName, const string& component, ActionF
       return;
     }
 
+    if (input == "r" || input == "R") {
+      long long from, to;
+      if (!readTimeRange(from, to)) {
+        continue;
+      }
+      rangeAction(component, from, to);
+
+      return;
+    }
+
+    if (temperatureAction && (input == "t" || input == "T")) {
+      long long from, to;
+      double low, high;
+      if (!readTimeRange(from, to) || !readTemperatureBounds(low, high)) {
+        continue;
+      }
+      temperatureAction(component, from, to, low, high);
+
+      return;
+    }
+
+    if (aggregateAction && (input == "a" || input == "A")) {
+      long long from, to;
+      if (!readTimeRange(from, to)) {
+        continue;
+      }
+
+      string stepInput;
+      cout << "Bucket width in seconds (e.g. 60 or 3600): ";
+      getline(cin, stepInput);
+      long long step = 0;
+      try {
+        step = stoll(stepInput);
+      }
+      catch (const exception&) {
+        step = 0;
+      }
+      if (step <= 0) {
+        cout << "Invalid bucket width. Please enter a positive number of seconds.\n";
+        continue;
+      }
+      aggregateAction(component, from, to, step);
+
+      return;
+    }
+
+    if (olderAction && (input == "o" || input == "O")) {
+      string timeInput;
+      clearInputBuffer();
+      cout << "Older than (YYYY-MM-DD HH:MM[:SS] or Unix timestamp): ";
+      getline(cin, timeInput);
+      try {
+        olderAction(component, parseTimestamp(timeInput));
+      }
+      catch (const invalid_argument& e) {
+        cout << e.what() << "\n";
+        continue;
+      }
+
+      return;
+    }
+
     try {
       int recordCount = stoi(input);
       if (recordCount < 0) {
@@ -123,22 +325,51 @@ void handleRecords(const string& operationName, const string& component, ActionF
 /**
  * @brief Displays and handles menu for selected operation.
  *
+ * Add and Monitor offer the components of the local machine. List, Export and Delete offer every
+ * component stored by the engine, including the "<Component>@<Host>" series of polled hosts, and
+ * refresh the choices each time the menu is shown.
+ *
  * @param opType
  *   Operation type (ADD/MONITOR/LIST/EXPORT/DELETE)
  * @param title
  *   Title displayed in menu header
  * @param handler
  *   Function to execute when operation is selected
+ * @param rangeHandler
+ *   Function to execute when operation is selected for a time range
+ * @param olderHandler
+ *   Function to execute when operation is selected for records older than a point in time
+ * @param aggregateHandler
+ *   Function to execute when operation is selected for aggregates over a time range
+ * @param temperatureHandler
+ *   Function to execute when operation is selected for a time range within temperature bounds
  */
-void showOperationMenu(OperationType opType, const string& title,
-                       function<void(const string&, int, bool)> handler) {
+void showOperationMenu(
+    OperationType opType, const string& title, function<void(const string&, int, bool)> handler,
+    function<void(const string&, long long, long long)> rangeHandler,
+    function<void(const string&, long long)> olderHandler = nullptr,
+    function<void(const string&, long long, long long, long long)> aggregateHandler = nullptr,
+    function<void(const string&, long long, long long, double, double)> temperatureHandler =
+        nullptr) {
   while (true) {
+    vector<string> components;
+    if (opType == OperationType::ADD || opType == OperationType::MONITOR) {
+      for (const auto& [type, name] : COMPONENT_NAMES) {
+        if (type != ComponentType::ALL) {
+          components.push_back(name);
+        }
+      }
+    }
+    else {
+      components = FileSource().getComponents();
+    }
+    components.push_back(COMPONENT_NAMES.at(ComponentType::ALL));
+
     cout << "\n--- " << title << " ---\n";
-    cout << "1. GPU\n";
-    cout << "2. CPU\n";
-    cout << "3. Motherboard\n";
-    cout << "4. All components\n";
-    cout << "5. Back to Main Menu\n";
+    for (size_t i = 0; i < components.size(); ++i) {
+      cout << i + 1 << ". " << components[i] << "\n";
+    }
+    cout << components.size() + 1 << ". Back to Main Menu\n";
 
     int choice;
     cout << "Select an option: ";
@@ -148,16 +379,15 @@ void showOperationMenu(OperationType opType, const string& title,
       continue;
     }
 
-    if (choice == 5)
+    if (choice == static_cast<int>(components.size()) + 1)
       return;
 
-    if (choice < 1 || choice > 4) {
+    if (choice < 1 || choice > static_cast<int>(components.size())) {
       cout << "Invalid option, please try again.\n";
       continue;
     }
 
-    ComponentType component = static_cast<ComponentType>(choice - 1);
-    const string& componentName = COMPONENT_NAMES.at(component);
+    const string& componentName = components[choice - 1];
 
     switch (opType) {
     case OperationType::ADD:
@@ -169,7 +399,8 @@ void showOperationMenu(OperationType opType, const string& title,
       continue;
 
     default:
-      handleRecords(title, componentName, handler);
+      handleRecords(title, componentName, handler, rangeHandler, olderHandler, aggregateHandler,
+                    temperatureHandler);
     }
   }
 }
@@ -182,11 +413,15 @@ void showOperationMenu(OperationType opType, const string& title,
  */
 void runCLI() {
   map<int, MenuItem> mainMenu = {
-      {1, {"Add", []() { showOperationMenu(OperationType::ADD, "Add Component", nullptr); }}},
+      {1,
+       {"Add",
+        []() { showOperationMenu(OperationType::ADD, "Add Component", nullptr, nullptr); }}},
 
       {2,
        {"Monitor",
-        []() { showOperationMenu(OperationType::MONITOR, "Monitor Component", nullptr); }}},
+        []() {
+          showOperationMenu(OperationType::MONITOR, "Monitor Component", nullptr, nullptr);
+        }}},
 
       {3,
        {"List",
@@ -210,6 +445,66 @@ void runCLI() {
                               catch (const std::exception& e) {
                                 cerr << "Error: " << e.what() << endl;
                               }
+                            },
+                            [](const string& comp, long long from, long long to) {
+                              try {
+                                FileSource source;
+                                std::string fileComponent =
+                                    (comp == "All components") ? "all_measurements" : comp;
+                                auto records = source.getRange(fileComponent, from, to);
+
+                                cout << "Showing " << records.size() << " record(s) for " << comp
+                                     << ":\n";
+                                for (const auto& r : records) {
+                                  cout << " - Temp: " << r.temperature << "°C"
+                                       << ", Timestamp: " << r.timestamp << "\n";
+                                }
+                              }
+                              catch (const std::exception& e) {
+                                cerr << "Error: " << e.what() << endl;
+                              }
+                            },
+                            nullptr,
+                            [](const string& comp, long long from, long long to, long long step) {
+                              if (comp == "All components") {
+                                cout << "Aggregates are listed per component.\n";
+                                return;
+                              }
+                              try {
+                                FileSource source;
+                                auto buckets = source.getRollups(comp, from, to, step);
+
+                                cout << "Showing " << buckets.size() << " bucket(s) of " << step
+                                     << " s for " << comp << ":\n";
+                                for (const auto& b : buckets) {
+                                  cout << " - Start: " << b.start << ", Min: " << b.min
+                                       << "°C, Max: " << b.max << "°C, Avg: " << b.sum / b.count
+                                       << "°C, Count: " << b.count << "\n";
+                                }
+                              }
+                              catch (const std::exception& e) {
+                                cerr << "Error: " << e.what() << endl;
+                              }
+                            },
+                            [](const string& comp, long long from, long long to, double low,
+                               double high) {
+                              try {
+                                FileSource source;
+                                std::string fileComponent =
+                                    (comp == "All components") ? "all_measurements" : comp;
+                                auto records =
+                                    source.findTemperature(fileComponent, from, to, low, high);
+
+                                cout << "Showing " << records.size() << " record(s) for " << comp
+                                     << ":\n";
+                                for (const auto& r : records) {
+                                  cout << " - Temp: " << r.temperature << "°C"
+                                       << ", Timestamp: " << r.timestamp << "\n";
+                                }
+                              }
+                              catch (const std::exception& e) {
+                                cerr << "Error: " << e.what() << endl;
+                              }
                             });
         }}},
 
@@ -225,6 +520,26 @@ void runCLI() {
                               catch (const std::exception& e) {
                                 cerr << "Error: " << e.what() << endl;
                               }
+                            },
+                            [](const string& comp, long long from, long long to) {
+                              try {
+                                FileSource source;
+                                source.exportRangeToCSV(comp, from, to);
+                              }
+                              catch (const std::exception& e) {
+                                cerr << "Error: " << e.what() << endl;
+                              }
+                            },
+                            nullptr, nullptr,
+                            [](const string& comp, long long from, long long to, double low,
+                               double high) {
+                              try {
+                                FileSource source;
+                                source.exportTemperatureToCSV(comp, from, to, low, high);
+                              }
+                              catch (const std::exception& e) {
+                                cerr << "Error: " << e.what() << endl;
+                              }
                             });
         }}},
 
@@ -239,7 +554,7 @@ void runCLI() {
                                 if (comp == "All components") {
                                   source.deleteMeasurements("All components", count, fromStart);
                                   cout << "Deleted " << (count == 0 ? "all" : to_string(count))
-                                       << " record(s) from all_measurements.json.\n";
+                                       << " record(s) from all components.\n";
                                 }
                                 else {
                                   source.deleteMeasurements(comp, count, fromStart);
@@ -250,6 +565,28 @@ void runCLI() {
                               catch (const std::exception& e) {
                                 cerr << "Error: " << e.what() << endl;
                               }
+                            },
+                            [](const string& comp, long long from, long long to) {
+                              try {
+                                FileSource source;
+                                size_t deleted = source.deleteRange(comp, from, to);
+                                cout << "Deleted " << deleted << " record(s) for " << comp
+                                     << ".\n";
+                              }
+                              catch (const std::exception& e) {
+                                cerr << "Error: " << e.what() << endl;
+                              }
+                            },
+                            [](const string& comp, long long timestamp) {
+                              try {
+                                FileSource source;
+                                size_t deleted = source.deleteOlderThan(comp, timestamp);
+                                cout << "Deleted " << deleted << " record(s) for " << comp
+                                     << ".\n";
+                              }
+                              catch (const std::exception& e) {
+                                cerr << "Error: " << e.what() << endl;
+                              }
                             });
         }}},
       {6, {"Benchmark", []() { runBenchmark(); }}}};
@@ -1,20 +1,27 @@
 // Standard library headers
 #include <iostream>
+#include <stdexcept>
 #include <vector>
 
 // Project headers
 #include "config/config_loader.h"
+#include "storage/storage_engine.h"
 
 std::string ConfigLoader::CPU = "";
 std::string ConfigLoader::GPU = "";
 std::string ConfigLoader::MOTHERBOARD = "";
 std::string ConfigLoader::CHIP = "";
+std::string ConfigLoader::WAL_FSYNC = "always";
+int ConfigLoader::WAL_FSYNC_INTERVAL_MS = 100;
+std::unordered_map<std::string, std::string> ConfigLoader::RETENTION;
+std::map<std::string, std::string> ConfigLoader::OHM_HOSTS;
+int ConfigLoader::OHM_TIMEOUT_MS = 1000;
 
 /**
  * @brief Validates that all required component values are loaded from config.
  *
  * @throws std::runtime_error
- *   If any required component is missing or empty
+ *   If any required component is missing or empty, or an option has an invalid value
  */
 void ConfigLoader::validate() {
   std::vector<std::string> missing;
@@ -35,4 +42,40 @@ void ConfigLoader::validate() {
     throw std::runtime_error(
         "Please complete the configuration file before running the program.\n");
   }
+
+  if (WAL_FSYNC != "always" && WAL_FSYNC != "interval" && WAL_FSYNC != "os") {
+    throw std::runtime_error("WAL_FSYNC must be one of: always, interval, os.\n");
+  }
+
+  if (WAL_FSYNC_INTERVAL_MS < 1) {
+    throw std::runtime_error("WAL_FSYNC_INTERVAL_MS must be greater than 0.\n");
+  }
+
+  for (const auto& [host, url] : OHM_HOSTS) {
+    if (host.empty() ||
+        host.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"
+                               "0123456789._-") != std::string::npos) {
+      throw std::runtime_error("OHM_HOST_" + host +
+                               " must be named with letters, digits, '.', '_' or '-'.\n");
+    }
+    if (url.empty()) {
+      throw std::runtime_error("OHM_HOST_" + host + " must be set to the URL of data.json.\n");
+    }
+  }
+
+  if (OHM_TIMEOUT_MS < 1) {
+    throw std::runtime_error("OHM_TIMEOUT_MS must be greater than 0.\n");
+  }
+
+  for (const auto& [component, policy] : RETENTION) {
+    try {
+      StorageEngine::parseRetention(policy);
+    }
+    catch (const std::invalid_argument& e) {
+      std::string key = component.empty() ? "RETENTION" : "RETENTION_" + component;
+      throw std::runtime_error(key + " is invalid (" + e.what() +
+                               "); expected tiers raw, minute and hour with periods such as 7d "
+                               "or forever, e.g. raw:7d, minute:90d, hour:forever.\n");
+    }
+  }
 }
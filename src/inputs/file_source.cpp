@@ -1,14 +1,23 @@
 // Standard library headers
+#include <algorithm>
+#include <climits>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <unordered_map>
 
-// Third-party libraries
-#include <nlohmann/json.hpp>
+// System headers
+#include <dirent.h>
 
 // Project headers
 #include "inputs/file_source.h"
+#include "inputs/json_stream_reader.h"
+#include "inputs/json_tail_reader.h"
 #include "storage/index_manager.h"
+#include "storage/merge_iterator.h"
+#include "storage/segment_log.h"
+#include "storage/storage_engine.h"
 #include "utils/utils.h"
 
 /**
@@ -28,49 +37,471 @@
  */
 std::vector<Measurement> FileSource::getMeasurements(const std::string& component, int count,
                                                      bool fromStart) {
-  std::string filePath = getDataDirectory() + "/" + component + ".json";
-  std::ifstream file(filePath);
-  nlohmann::json data;
+  if (component == SegmentLog::ALL_SERIES) {
+    return getMergedMeasurements(count, fromStart);
+  }
+
+  auto records = readComponent(component, count, fromStart);
+  if (records.empty()) {
+    throw std::runtime_error("No records found for: " + component);
+  }
+
+  return records;
+}
+
+/**
+ * @brief Retrieves measurements of a component with timestamps in the range [from, to).
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU") or "all_measurements".
+ * @param from
+ *   First timestamp of the range.
+ * @param to
+ *   Timestamp one past the range.
+ *
+ * @return std::vector<Measurement>
+ *   List of measurement records.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::getRange(const std::string& component, long long from,
+                                              long long to) {
+  if (component == SegmentLog::ALL_SERIES) {
+    return getMergedRange(from, to);
+  }
+
+  auto records = readComponentRange(component, from, to);
+  if (records.empty()) {
+    throw std::runtime_error("No records found for: " + component);
+  }
+
+  return records;
+}
+
+/**
+ * @brief Retrieves min/max/sum/count buckets of a component over a time range.
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU").
+ * @param begin
+ *   First timestamp of the range.
+ * @param end
+ *   Timestamp one past the range.
+ * @param step
+ *   Width of the buckets in seconds.
+ *
+ * @return std::vector<Rollup>
+ *   Non-empty buckets ordered by start.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Rollup> FileSource::getRollups(const std::string& component, long long begin,
+                                           long long end, long long step) {
+  StorageEngine& engine = StorageEngine::getInstance();
+  if (!engine.exists(component)) {
+    throw std::runtime_error("No records found for: " + component);
+  }
+
+  return engine.readRollups(component, begin, end, step);
+}
+
+/**
+ * @brief Retrieves measurements of a component within a time range and a temperature interval.
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU") or "all_measurements".
+ * @param from
+ *   First timestamp of the range.
+ * @param to
+ *   Timestamp one past the range.
+ * @param low
+ *   Lowest matching temperature.
+ * @param high
+ *   Highest matching temperature.
+ *
+ * @return std::vector<Measurement>
+ *   Matching records ordered by timestamp.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::findTemperature(const std::string& component, long long from,
+                                                     long long to, double low, double high) {
+  StorageEngine& engine = StorageEngine::getInstance();
+  std::vector<std::string> components = getComponents();
+  if (component != SegmentLog::ALL_SERIES) {
+    if (!std::binary_search(components.begin(), components.end(), component)) {
+      throw std::runtime_error("No records found for: " + component);
+    }
+    components = {component};
+  }
+
+  std::vector<std::vector<Measurement>> series;
+  for (const auto& name : components) {
+    // Legacy records are filtered while streaming; the engine skips chunks by their bounds.
+    std::vector<Measurement> legacy = getLegacyRange(name, from, to);
+    legacy.erase(std::remove_if(legacy.begin(), legacy.end(),
+                                [&](const Measurement& m) {
+                                  return m.temperature < low || m.temperature > high;
+                                }),
+                 legacy.end());
+    series.push_back(std::move(legacy));
+    series.push_back(engine.findTemperature(name, from, to, low, high));
+  }
+
+  MergeIterator merged(std::move(series));
+  std::vector<Measurement> result;
+  Measurement m;
+  while (merged.next(m)) {
+    result.push_back(m);
+  }
+
+  return result;
+}
+
+/**
+ * @brief Retrieves the names of all components stored by the storage engine or in legacy JSON
+ * files.
+ *
+ * @return std::vector<std::string>
+ *   Component names in alphabetical order, so the series of one component on several hosts are
+ *   listed together.
+ */
+std::vector<std::string> FileSource::getComponents() {
+  std::vector<std::string> components = StorageEngine::getInstance().getSeries();
+  for (const auto& component : getLegacyComponents()) {
+    components.push_back(component);
+  }
+
+  std::sort(components.begin(), components.end());
+  components.erase(std::unique(components.begin(), components.end()), components.end());
+
+  return components;
+}
+
+/**
+ * @brief Retrieves measurements of all components through a k-way merge ordered by timestamp.
+ *
+ * Every prefix or suffix of the merged series is made of a prefix or suffix of each component,
+ * so at most count records are read per component.
+ *
+ * @param count
+ *   Number of records to retrieve (0 for all).
+ * @param fromStart
+ *   If true, reads records from the beginning; otherwise, from the end.
+ *
+ * @return std::vector<Measurement>
+ *   List of measurement records.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::getMergedMeasurements(int count, bool fromStart) {
+  std::vector<std::vector<Measurement>> series;
+  for (const auto& component : getComponents()) {
+    series.push_back(readComponent(component, count, fromStart));
+  }
+
+  MergeIterator merged(std::move(series));
+  std::vector<Measurement> result;
+  Measurement m;
+  while ((!fromStart || count <= 0 || result.size() < (size_t)count) && merged.next(m)) {
+    result.push_back(m);
+  }
+
+  if (!fromStart && count > 0 && result.size() > (size_t)count) {
+    result.erase(result.begin(), result.end() - count);
+  }
+
+  if (result.empty()) {
+    throw std::runtime_error("No records found for: " + std::string(SegmentLog::ALL_SERIES));
+  }
+
+  return result;
+}
+
+/**
+ * @brief Retrieves measurements of all components within a time range through a k-way merge.
+ *
+ * @param from
+ *   First timestamp of the range.
+ * @param to
+ *   Timestamp one past the range.
+ *
+ * @return std::vector<Measurement>
+ *   List of measurement records.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::getMergedRange(long long from, long long to) {
+  std::vector<std::vector<Measurement>> series;
+  for (const auto& component : getComponents()) {
+    series.push_back(readComponentRange(component, from, to));
+  }
+
+  MergeIterator merged(std::move(series));
+  std::vector<Measurement> result;
+  Measurement m;
+  while (merged.next(m)) {
+    result.push_back(m);
+  }
+
+  if (result.empty()) {
+    throw std::runtime_error("No records found for: " + std::string(SegmentLog::ALL_SERIES));
+  }
+
+  return result;
+}
 
+/**
+ * @brief Retrieves the oldest or newest measurements of a component from its legacy JSON file and
+ * the storage engine.
+ *
+ * Legacy records are older than the records of the engine that share their timestamp, so they
+ * come first in the merge. Every prefix or suffix of the merged records is made of a prefix or
+ * suffix of each source, so at most count records are read from either.
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU").
+ * @param count
+ *   Number of records to retrieve (0 for all).
+ * @param fromStart
+ *   If true, reads records from the beginning; otherwise, from the end.
+ * @param legacyCount
+ *   Receives how many of the returned records come from the legacy file, if not null.
+ *
+ * @return std::vector<Measurement>
+ *   List of measurement records, empty if the component has none.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::readComponent(const std::string& component, int count,
+                                                   bool fromStart, size_t* legacyCount) {
+  std::vector<Measurement> legacy = getLegacyMeasurements(component, count, fromStart);
+  std::vector<Measurement> stored = StorageEngine::getInstance().read(component, count, fromStart);
+  if (legacy.empty()) {
+    if (legacyCount) {
+      *legacyCount = 0;
+    }
+
+    return stored;
+  }
+
+  MergeIterator merged({std::move(legacy), std::move(stored)});
+  std::vector<Measurement> result;
+  std::vector<size_t> sources;
+  Measurement m;
+  size_t index = 0;
+  while ((!fromStart || count <= 0 || result.size() < (size_t)count) && merged.next(m, index)) {
+    result.push_back(m);
+    sources.push_back(index);
+  }
+
+  if (!fromStart && count > 0 && result.size() > (size_t)count) {
+    result.erase(result.begin(), result.end() - count);
+    sources.erase(sources.begin(), sources.end() - count);
+  }
+
+  if (legacyCount) {
+    *legacyCount = std::count(sources.begin(), sources.end(), 0);
+  }
+
+  return result;
+}
+
+/**
+ * @brief Retrieves measurements of a component within a time range from its legacy JSON file and
+ * the storage engine.
+ *
+ * The timestamp index covers both, so an empty range is answered by two binary searches and the
+ * legacy file is only read for the records of the range the engine does not hold.
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU").
+ * @param from
+ *   First timestamp of the range.
+ * @param to
+ *   Timestamp one past the range.
+ *
+ * @return std::vector<Measurement>
+ *   List of measurement records, empty if the component has none.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::readComponentRange(const std::string& component,
+                                                        long long from, long long to) {
+  size_t indexed = IndexManager::getInstance().getRange(component, from, to).size();
+  if (indexed == 0) {
+    return {};
+  }
+
+  std::vector<Measurement> stored = StorageEngine::getInstance().readRange(component, from, to);
+  if (indexed <= stored.size()) {
+    return stored;
+  }
+
+  std::vector<Measurement> legacy = getLegacyRange(component, from, to, indexed - stored.size());
+  if (legacy.empty()) {
+    return stored;
+  }
+
+  MergeIterator merged({std::move(legacy), std::move(stored)});
+  std::vector<Measurement> result;
+  Measurement m;
+  while (merged.next(m)) {
+    result.push_back(m);
+  }
+
+  return result;
+}
+
+/**
+ * @brief Retrieves measurements from a legacy JSON file.
+ *
+ * The file is never loaded as a whole: reading from the start streams records and stops as soon
+ * as count records have been taken, reading from the end scans the file backwards.
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU").
+ * @param count
+ *   Number of records to retrieve (0 for all).
+ * @param fromStart
+ *   If true, reads records from the beginning; otherwise, from the end.
+ *
+ * @return std::vector<Measurement>
+ *   List of measurement records, empty if the component has no legacy file.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::getLegacyMeasurements(const std::string& component, int count,
+                                                           bool fromStart) {
+  std::string filePath = getLegacyPath(component);
+  std::ifstream file(filePath, std::ios::binary);
   if (!file) {
-    throw std::runtime_error("No file found for component: " + component);
+    return {};
   }
 
+  // The newest records are found by scanning the file backwards.
+  if (!fromStart && count > 0) {
+    file.close();
+    try {
+      return JsonTailReader(filePath).readLast(count);
+    }
+    catch (...) {
+      throw std::runtime_error("Failed to parse JSON for: " + component);
+    }
+  }
+
+  std::vector<Measurement> result;
+  JsonStreamReader reader([&](const Measurement& m) {
+    result.push_back(m);
+
+    return count <= 0 || result.size() < (size_t)count;
+  });
+
   try {
-    file >> data;
+    reader.parse(file);
   }
   catch (...) {
     throw std::runtime_error("Failed to parse JSON for: " + component);
   }
 
-  if (!data.is_array() || data.empty()) {
-    throw std::runtime_error("No records found for: " + component);
+  return result;
+}
+
+/**
+ * @brief Retrieves measurements within a time range from a legacy JSON file.
+ *
+ * Records were appended in timestamp order, so streaming stops at the first record past the
+ * range, or earlier once the expected number of records was read.
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU").
+ * @param from
+ *   First timestamp of the range.
+ * @param to
+ *   Timestamp one past the range.
+ * @param expected
+ *   Number of records of the range the file holds at most.
+ *
+ * @return std::vector<Measurement>
+ *   List of measurement records, empty if the component has no legacy file.
+ *
+ * @throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::getLegacyRange(const std::string& component, long long from,
+                                                    long long to, size_t expected) {
+  std::ifstream file(getLegacyPath(component), std::ios::binary);
+  if (!file) {
+    return {};
   }
 
   std::vector<Measurement> result;
-  size_t total = data.size();
-  size_t begin = 0;
-  size_t end = total;
+  JsonStreamReader reader([&](const Measurement& m) {
+    if (m.timestamp >= from && m.timestamp < to) {
+      result.push_back(m);
+    }
 
-  if (count > 0 && (size_t)count < total) {
-    if (fromStart) {
-      end = count;
+    return m.timestamp < to && result.size() < expected;
+  });
+
+  try {
+    reader.parse(file);
+  }
+  catch (...) {
+    throw std::runtime_error("Failed to parse JSON for: " + component);
+  }
+
+  return result;
+}
+
+/**
+ * @brief Retrieves the names of the components that still have a legacy JSON file.
+ *
+ * The all_measurements file only duplicates the component files and the index files are no
+ * measurements, so both are skipped.
+ *
+ * @return std::vector<std::string>
+ *   Component names in directory order.
+ */
+std::vector<std::string> FileSource::getLegacyComponents() {
+  std::vector<std::string> components;
+  DIR* dir = opendir(getDataDirectory().c_str());
+  if (!dir) {
+    return components;
+  }
+
+  const std::string suffix = ".json";
+  while (dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() <= suffix.size() ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+      continue;
     }
-    else {
-      begin = total - count;
+
+    name.erase(name.size() - suffix.size());
+    if (name != SegmentLog::ALL_SERIES && name != "index") {
+      components.push_back(name);
     }
   }
+  closedir(dir);
 
-  for (size_t i = begin; i < end; ++i) {
-    const auto& rec = data[i];
-    result.push_back({rec["Component"], rec["Temperature"], rec["Timestamp"]});
-  }
+  return components;
+}
 
-  return result;
+/**
+ * @brief Retrieves the path of the legacy JSON file of a component.
+ *
+ * @param component
+ *   The name of the hardware component (e.g., "CPU", "GPU").
+ *
+ * @return std::string
+ *   Path inside the data directory.
+ */
+std::string FileSource::getLegacyPath(const std::string& component) {
+  return getDataDirectory() + "/" + component + ".json";
 }
 
 /**
- * @brief Deletes measurement records from JSON storage.
+ * @brief Deletes measurement records from the storage engine and legacy JSON files.
  *
  * @param component
  *   The component name or "All components".
@@ -91,129 +522,168 @@ void FileSource::deleteMeasurements(const std::string& component, int count, boo
 }
 
 /**
- * @brief Deletes records for all components.
+ * @brief Deletes measurement records within a time range from the storage engine and legacy JSON
+ * files.
  *
- * @param count
- *   Number of records to delete (0 for all).
- * @param fromStart
- *   If true, deletes from the beginning; otherwise, from the end.
+ * @param component
+ *   The component name or "All components".
+ * @param from
+ *   First timestamp of the range.
+ * @param to
+ *   Timestamp one past the range.
+ *
+ * @return size_t
+ *   Number of deleted records.
  *
  * @throws std::runtime_error
  */
-void FileSource::deleteFromAllComponents(int count, bool fromStart) {
-  std::string allFile = getDataDirectory() + "/all_measurements.json";
-  nlohmann::json allData = loadJsonFromFile(allFile);
+size_t FileSource::deleteRange(const std::string& component, long long from, long long to) {
+  StorageEngine& engine = StorageEngine::getInstance();
+  std::vector<std::string> components = getComponents();
+  if (component != "All components") {
+    components = {component};
+  }
 
-  auto deletedRecords = extractDeletedRecords(allData, count, fromStart);
-  saveJsonToFile(allFile, allData);
+  size_t deleted = 0;
+  for (const auto& comp : components) {
+    auto deletedTimestamps = deleteLegacyRange(comp, from, to);
+    auto removed = engine.removeRange(comp, from, to);
+    deletedTimestamps.insert(deletedTimestamps.end(), removed.begin(), removed.end());
 
-  std::unordered_map<std::string, std::vector<long long>> toDeleteByComponent;
-  for (const auto& rec : deletedRecords) {
-    if (rec.contains("Component") && rec.contains("Timestamp")) {
-      toDeleteByComponent[rec["Component"]].push_back(rec["Timestamp"]);
+    if (!deletedTimestamps.empty()) {
+      IndexManager::getInstance().deleteTimestamps(comp, deletedTimestamps);
+      deleted += deletedTimestamps.size();
     }
   }
 
-  for (const auto& [comp, timestamps] : toDeleteByComponent) {
-    updateComponentFile(comp, timestamps);
-    IndexManager::getInstance().deleteTimestamps(comp, timestamps);
+  if (deleted == 0) {
+    throw std::runtime_error("No records found for: " + component);
   }
+
+  return deleted;
 }
 
 /**
- * @brief Deletes records for a single component.
+ * @brief Deletes measurement records older than a timestamp from the storage engine and legacy
+ * JSON files.
  *
  * @param component
- *   Name of the component.
- * @param count
- *   Number of records to delete (0 for all).
- * @param fromStart
- *   If true, deletes from the beginning; otherwise, from the end.
+ *   The component name or "All components".
+ * @param timestamp
+ *   Oldest timestamp to keep.
+ *
+ * @return size_t
+ *   Number of deleted records.
  *
  * @throws std::runtime_error
  */
-void FileSource::deleteFromSingleComponent(const std::string& component, int count,
-                                           bool fromStart) {
-  std::string filePath = getDataDirectory() + "/" + component + ".json";
-  nlohmann::json data = loadJsonFromFile(filePath);
-
-  auto deletedRecords = extractDeletedRecords(data, count, fromStart);
-  saveJsonToFile(filePath, data);
+size_t FileSource::deleteOlderThan(const std::string& component, long long timestamp) {
+  StorageEngine& engine = StorageEngine::getInstance();
+  std::vector<std::string> components = getComponents();
+  if (component != "All components") {
+    if (!std::binary_search(components.begin(), components.end(), component)) {
+      throw std::runtime_error("No records found for: " + component);
+    }
+    components = {component};
+  }
 
-  auto deletedTimestamps = extractTimestamps(deletedRecords);
-  IndexManager::getInstance().deleteTimestamps(component, deletedTimestamps);
+  size_t deleted = 0;
+  for (const auto& comp : components) {
+    size_t count = deleteLegacyRange(comp, LLONG_MIN, timestamp).size();
+    count += engine.dropBefore(comp, timestamp);
+    if (count > 0) {
+      IndexManager::getInstance().deleteOlderThan(comp, timestamp);
+      deleted += count;
+    }
+  }
 
-  updateAllMeasurementsFile(deletedTimestamps);
+  return deleted;
 }
 
 /**
- * @brief Loads JSON data from a file.
+ * @brief Deletes records for all components from the storage engine and legacy JSON files.
  *
- * @param path
- *   File path to load from.
+ * The records to delete are selected through the merged view; they form a prefix or suffix of
+ * every component, so each component is cut by the number of its records among them.
  *
- * @return nlohmann::json
- *   Loaded JSON data.
+ * @param count
+ *   Number of records to delete (0 for all).
+ * @param fromStart
+ *   If true, deletes from the beginning; otherwise, from the end.
  *
  * @throws std::runtime_error
  */
-nlohmann::json FileSource::loadJsonFromFile(const std::string& path) {
-  std::ifstream file(path);
-  if (!file) {
-    throw std::runtime_error("Cannot open file: " + path);
-  }
+void FileSource::deleteFromAllComponents(int count, bool fromStart) {
+  auto records = getMergedMeasurements(count, fromStart);
 
-  nlohmann::json data;
-  try {
-    file >> data;
-  }
-  catch (...) {
-    throw std::runtime_error("Failed to parse JSON: " + path);
+  std::unordered_map<std::string, int> toDeleteByComponent;
+  for (const auto& rec : records) {
+    ++toDeleteByComponent[rec.component];
   }
 
-  if (!data.is_array() || data.empty()) {
-    throw std::runtime_error("No valid data in: " + path);
+  for (const auto& [comp, deleted] : toDeleteByComponent) {
+    deleteFromSingleComponent(comp, deleted, fromStart);
   }
-
-  return data;
 }
 
 /**
- * @brief Saves JSON data to a file.
+ * @brief Deletes records for a single component from its legacy JSON file and the storage engine.
  *
- * @param path
- *   File path to save to.
- * @param data
- *   JSON data to save.
+ * The records to delete are selected through the merged view of both, which tells how many of
+ * them each one holds.
+ *
+ * @param component
+ *   Name of the component.
+ * @param count
+ *   Number of records to delete (0 for all).
+ * @param fromStart
+ *   If true, deletes from the beginning; otherwise, from the end.
  *
  * @throws std::runtime_error
  */
-void FileSource::saveJsonToFile(const std::string& path, const nlohmann::json& data) {
-  std::ofstream file(path);
-  if (!file) {
-    throw std::runtime_error("Cannot save file: " + path);
+void FileSource::deleteFromSingleComponent(const std::string& component, int count,
+                                           bool fromStart) {
+  size_t legacyCount = 0;
+  size_t total = readComponent(component, count, fromStart, &legacyCount).size();
+  if (total == 0) {
+    throw std::runtime_error("No records found for: " + component);
+  }
+
+  std::vector<long long> deletedTimestamps;
+  if (legacyCount > 0) {
+    deletedTimestamps = deleteLegacyRecords(component, legacyCount, fromStart);
   }
-  file << data.dump(4);
+
+  if (total > legacyCount) {
+    auto removed = StorageEngine::getInstance().remove(component, total - legacyCount, fromStart);
+    deletedTimestamps.insert(deletedTimestamps.end(), removed.begin(), removed.end());
+  }
+
+  IndexManager::getInstance().deleteTimestamps(component, deletedTimestamps);
 }
 
 /**
- * @brief Extracts records to delete from JSON array.
+ * @brief Deletes the oldest or newest records of a legacy JSON file.
  *
- * @param data
- *   JSON array of records.
+ * @param component
+ *   Name of the component.
  * @param count
- *   Number of records to extract.
+ *   Number of records to delete (0 for all).
  * @param fromStart
- *   If true, from beginning; otherwise, from end.
+ *   If true, deletes from the beginning; otherwise, from the end.
+ *
+ * @return std::vector<long long>
+ *   Timestamps of the deleted records.
  *
- * @return std::vector<nlohmann::json>
- *   Extracted records.
+ * @throws std::runtime_error
  */
-std::vector<nlohmann::json> FileSource::extractDeletedRecords(nlohmann::json& data, int count,
-                                                              bool fromStart) {
+std::vector<long long> FileSource::deleteLegacyRecords(const std::string& component, int count,
+                                                       bool fromStart) {
+  std::string filePath = getLegacyPath(component);
+  nlohmann::json data = loadJsonFromFile(filePath);
+
   size_t total = data.size();
   size_t begin = 0, end = total;
-
   if (count > 0 && (size_t)count < total) {
     if (fromStart)
       end = count;
@@ -221,81 +691,111 @@ std::vector<nlohmann::json> FileSource::extractDeletedRecords(nlohmann::json& da
       begin = total - count;
   }
 
-  std::vector<nlohmann::json> records(data.begin() + begin, data.begin() + end);
+  std::vector<long long> timestamps;
+  for (size_t i = begin; i < end; ++i) {
+    if (data[i].contains("Timestamp") && data[i]["Timestamp"].is_number_integer()) {
+      timestamps.push_back(data[i]["Timestamp"].get<long long>());
+    }
+  }
+
   data.erase(data.begin() + begin, data.begin() + end);
-  return records;
+  saveJsonToFile(filePath, data);
+
+  return timestamps;
 }
 
 /**
- * @brief Extracts timestamps from a list of JSON records.
+ * @brief Deletes the records of a legacy JSON file within a time range.
  *
- * @param records
- *   Vector of JSON records.
+ * @param component
+ *   Name of the component.
+ * @param from
+ *   First timestamp of the range.
+ * @param to
+ *   Timestamp one past the range.
  *
  * @return std::vector<long long>
- *   List of timestamps.
+ *   Timestamps of the deleted records, empty if the component has no legacy file.
+ *
+ * @throws std::runtime_error
  */
-std::vector<long long> FileSource::extractTimestamps(const std::vector<nlohmann::json>& records) {
+std::vector<long long> FileSource::deleteLegacyRange(const std::string& component, long long from,
+                                                     long long to) {
+  std::string filePath = getLegacyPath(component);
+  if (getLegacyRange(component, from, to).empty()) {
+    return {};
+  }
+
+  nlohmann::json data = loadJsonFromFile(filePath);
   std::vector<long long> timestamps;
-  for (const auto& rec : records) {
-    if (rec.contains("Timestamp")) {
-      timestamps.push_back(rec["Timestamp"]);
+  nlohmann::json kept = nlohmann::json::array();
+
+  for (auto& rec : data) {
+    if (rec.contains("Timestamp") && rec["Timestamp"].is_number_integer()) {
+      long long timestamp = rec["Timestamp"].get<long long>();
+      if (timestamp >= from && timestamp < to) {
+        timestamps.push_back(timestamp);
+        continue;
+      }
     }
+
+    kept.push_back(std::move(rec));
   }
+
+  saveJsonToFile(filePath, kept);
+
   return timestamps;
 }
 
 /**
- * @brief Updates component file by removing specified timestamps.
+ * @brief Loads JSON data from a file.
  *
- * @param component
- *   Name of the component.
- * @param timestamps
- *   List of timestamps to remove.
+ * @param path
+ *   File path to load from.
+ *
+ * @return nlohmann::json
+ *   Loaded JSON data.
+ *
+ * @throws std::runtime_error
  */
-void FileSource::updateComponentFile(const std::string& component,
-                                     const std::vector<long long>& timestamps) {
-  std::string filePath = getDataDirectory() + "/" + component + ".json";
+nlohmann::json FileSource::loadJsonFromFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Cannot open file: " + path);
+  }
 
+  nlohmann::json data;
   try {
-    nlohmann::json data = loadJsonFromFile(filePath);
-    data.erase(std::remove_if(data.begin(), data.end(),
-                              [&](const nlohmann::json& rec) {
-                                return rec.contains("Timestamp") &&
-                                       std::find(timestamps.begin(), timestamps.end(),
-                                                 rec["Timestamp"]) != timestamps.end();
-                              }),
-               data.end());
-    saveJsonToFile(filePath, data);
+    file >> data;
   }
   catch (...) {
-    // File missing or bad format: ignore
+    throw std::runtime_error("Failed to parse JSON: " + path);
   }
+
+  if (!data.is_array()) {
+    throw std::runtime_error("No valid data in: " + path);
+  }
+
+  return data;
 }
 
 /**
- * @brief Updates all_measurements.json file by removing specified timestamps.
+ * @brief Saves JSON data to a file, removing the file once it holds no records.
  *
- * @param timestamps
- *   List of timestamps to remove.
+ * @param path
+ *   File path to save to.
+ * @param data
+ *   JSON data to save.
+ *
+ * @throws std::runtime_error
  */
-void FileSource::updateAllMeasurementsFile(const std::vector<long long>& timestamps) {
-  std::string allFile = getDataDirectory() + "/all_measurements.json";
-
-  try {
-    nlohmann::json allData = loadJsonFromFile(allFile);
-    allData.erase(std::remove_if(allData.begin(), allData.end(),
-                                 [&](const nlohmann::json& rec) {
-                                   return rec.contains("Timestamp") &&
-                                          std::find(timestamps.begin(), timestamps.end(),
-                                                    rec["Timestamp"]) != timestamps.end();
-                                 }),
-                  allData.end());
-    saveJsonToFile(allFile, allData);
-  }
-  catch (...) {
-    std::cerr << "Failed to update all_measurements.json\n";
+void FileSource::saveJsonToFile(const std::string& path, const nlohmann::json& data) {
+  if (data.empty()) {
+    std::remove(path.c_str());
+    return;
   }
+
+  writeFileDurably(path, data.dump(4));
 }
 
 /**
@@ -312,61 +812,70 @@ void FileSource::updateAllMeasurementsFile(const std::vector<long long>& timesta
  *   Throws on file I/O or JSON errors
  */
 void FileSource::exportToCSV(const std::string& component, int count, bool fromStart) {
-  std::vector<Measurement> measurements;
-
-  if (component == "All components") {
-    std::string filePath = getDataDirectory() + "/all_measurements.json";
-    std::ifstream file(filePath);
-    if (!file) {
-      throw std::runtime_error("No file found for all_measurements.json");
-    }
-
-    nlohmann::json data;
-    try {
-      file >> data;
-    }
-    catch (...) {
-      throw std::runtime_error("Failed to parse all_measurements.json");
-    }
-
-    if (!data.is_array() || data.empty()) {
-      throw std::runtime_error("No data to export in all_measurements.json");
-    }
-
-    size_t total = data.size();
-    size_t begin = 0, end = total;
-    if (count > 0 && (size_t)count < total) {
-      if (fromStart) {
-        end = count;
-      }
-      else {
-        begin = total - count;
-      }
-    }
-
-    for (size_t i = begin; i < end; ++i) {
-      const auto& rec = data[i];
-      measurements.push_back({rec["Component"], rec["Temperature"], rec["Timestamp"]});
-    }
-
-    filePath = getDataDirectory() + "/export/export_all.csv";
-    std::ofstream out(filePath);
-    if (!out) {
-      throw std::runtime_error("Failed to create export file.");
-    }
-
-    out << "Component,Temperature,Timestamp\n";
-    for (const auto& m : measurements) {
-      out << m.component << "," << m.temperature << "," << m.timestamp << "\n";
-    }
+  bool allComponents = component == "All components";
+  std::string series = allComponents ? SegmentLog::ALL_SERIES : component;
+  writeCSV(component, getMeasurements(series, count, fromStart));
+}
 
-    std::cout << "Exported " << measurements.size() << " record(s) to " << filePath << "\n";
+/**
+ * @brief Exports measurements within a time range to a CSV file.
+ *
+ * @param component std::string
+ *   Name of the component or "All components"
+ * @param from long long
+ *   First timestamp of the range
+ * @param to long long
+ *   Timestamp one past the range
+ *
+ * @return void
+ *   Throws on file I/O or JSON errors
+ */
+void FileSource::exportRangeToCSV(const std::string& component, long long from, long long to) {
+  bool allComponents = component == "All components";
+  std::string series = allComponents ? SegmentLog::ALL_SERIES : component;
+  writeCSV(component, getRange(series, from, to));
+}
 
-    return;
-  }
+/**
+ * @brief Exports measurements within a time range and a temperature interval to a CSV file.
+ *
+ * @param component std::string
+ *   Name of the component or "All components"
+ * @param from long long
+ *   First timestamp of the range
+ * @param to long long
+ *   Timestamp one past the range
+ * @param low double
+ *   Lowest matching temperature
+ * @param high double
+ *   Highest matching temperature
+ *
+ * @return void
+ *   Throws on file I/O errors
+ */
+void FileSource::exportTemperatureToCSV(const std::string& component, long long from, long long to,
+                                        double low, double high) {
+  bool allComponents = component == "All components";
+  std::string series = allComponents ? SegmentLog::ALL_SERIES : component;
+  writeCSV(component, findTemperature(series, from, to, low, high));
+}
 
-  measurements = getMeasurements(component, count, fromStart);
-  std::string filePath = getDataDirectory() + "/export/export_" + component + ".csv";
+/**
+ * @brief Writes measurements to the CSV export file of a component.
+ *
+ * @param component std::string
+ *   Name of the component or "All components"
+ * @param measurements std::vector<Measurement>
+ *   Measurements to write
+ *
+ * @return void
+ *   Throws if the export file cannot be created
+ */
+void FileSource::writeCSV(const std::string& component,
+                          const std::vector<Measurement>& measurements) {
+  bool allComponents = component == "All components";
+  std::string filePath = getDataDirectory() + "/export/export_" +
+                         (allComponents ? std::string("all") : component) + ".csv";
   std::ofstream csv(filePath);
   if (!csv) {
     throw std::runtime_error("Failed to create export file.");
@@ -393,3 +902,20 @@ Measurement FileSource::getMeasurement(const std::string& component) {
   throw std::runtime_error(
       "FileSource does not implement getMeasurement(). Use getMeasurements() instead.");
 }
+
+/**
+ * @brief Method required by interface, but not implemented in FileSource.
+ *
+ * @param components std::vector<std::string>
+ *   Required by interface; ignored in this implementation
+ * @param errors std::vector<std::string>
+ *   Required by interface; ignored in this implementation
+ *
+ * @return std::vector<Measurement>
+ *   Always throws std::runtime_error
+ */
+std::vector<Measurement> FileSource::getSnapshot(const std::vector<std::string>& components,
+                                                 std::vector<std::string>& errors) {
+  throw std::runtime_error(
+      "FileSource does not implement getSnapshot(). Use getMeasurements() instead.");
+}
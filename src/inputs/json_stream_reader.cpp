@@ -0,0 +1,252 @@
+// Standard library headers
+#include <stdexcept>
+
+// Project headers
+#include "inputs/json_stream_reader.h"
+
+/**
+ * @brief Creates a reader passing records to a callback.
+ *
+ * @param onRecord
+ *   Called for every parsed record
+ */
+JsonStreamReader::JsonStreamReader(Callback onRecord)
+    : onRecord(std::move(onRecord)), depth(0), current{"", 0.0, 0}, fields(0), stopped(false) {
+}
+
+/**
+ * @brief Parses a stream until its end or until the callback asks to stop.
+ *
+ * @param input
+ *   Stream holding a JSON array of records
+ *
+ * @throws std::runtime_error
+ *   If the JSON is malformed before parsing was stopped
+ */
+void JsonStreamReader::parse(std::istream& input) {
+  if (!nlohmann::json::sax_parse(input, this) && !stopped) {
+    throw std::runtime_error("Failed to parse JSON: " + error);
+  }
+}
+
+/**
+ * @brief Handles a null value.
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::null() {
+  return true;
+}
+
+/**
+ * @brief Handles a boolean value.
+ *
+ * @param val
+ *   Parsed value
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::boolean(bool val) {
+  return true;
+}
+
+/**
+ * @brief Handles a signed integer, stored if it belongs to a record field.
+ *
+ * @param val
+ *   Parsed value
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::number_integer(number_integer_t val) {
+  if (inRecord() && currentKey == "Timestamp") {
+    current.timestamp = val;
+    fields |= TIMESTAMP_FIELD;
+  }
+  else if (inRecord() && currentKey == "Temperature") {
+    current.temperature = static_cast<double>(val);
+    fields |= TEMPERATURE_FIELD;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Handles an unsigned integer, stored if it belongs to a record field.
+ *
+ * @param val
+ *   Parsed value
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::number_unsigned(number_unsigned_t val) {
+  return number_integer(static_cast<number_integer_t>(val));
+}
+
+/**
+ * @brief Handles a floating-point number, stored if it belongs to a record field.
+ *
+ * @param val
+ *   Parsed value
+ * @param s
+ *   Number as written in the input
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::number_float(number_float_t val, const string_t& s) {
+  if (inRecord() && currentKey == "Temperature") {
+    current.temperature = val;
+    fields |= TEMPERATURE_FIELD;
+  }
+  else if (inRecord() && currentKey == "Timestamp") {
+    current.timestamp = static_cast<long long>(val);
+    fields |= TIMESTAMP_FIELD;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Handles a string, stored if it is the component of a record.
+ *
+ * @param val
+ *   Parsed value
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::string(string_t& val) {
+  if (inRecord() && currentKey == "Component") {
+    current.component = std::move(val);
+    fields |= COMPONENT_FIELD;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Handles a binary value.
+ *
+ * @param val
+ *   Parsed value
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::binary(binary_t& val) {
+  return true;
+}
+
+/**
+ * @brief Handles the start of an object; objects of the top-level array start a record.
+ *
+ * @param elements
+ *   Number of elements if known
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::start_object(std::size_t elements) {
+  ++depth;
+  if (depth == 2) {
+    fields = 0;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Handles an object key.
+ *
+ * @param val
+ *   Parsed key
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::key(string_t& val) {
+  if (depth == 2) {
+    currentKey = val;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Handles the end of an object, passing a complete record to the callback.
+ *
+ * @return bool
+ *   False if the callback asked to stop
+ */
+bool JsonStreamReader::end_object() {
+  --depth;
+  if (depth == 1 && fields == ALL_FIELDS && !onRecord(current)) {
+    stopped = true;
+
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Handles the start of an array.
+ *
+ * @param elements
+ *   Number of elements if known
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::start_array(std::size_t elements) {
+  ++depth;
+
+  return true;
+}
+
+/**
+ * @brief Handles the end of an array.
+ *
+ * @return bool
+ *   Always true
+ */
+bool JsonStreamReader::end_array() {
+  --depth;
+
+  return true;
+}
+
+/**
+ * @brief Handles a parse error.
+ *
+ * @param position
+ *   Position of the error in the input
+ * @param last_token
+ *   Last read token
+ * @param ex
+ *   Exception describing the error
+ *
+ * @return bool
+ *   Always false
+ */
+bool JsonStreamReader::parse_error(std::size_t position, const std::string& last_token,
+                                   const nlohmann::detail::exception& ex) {
+  error = ex.what();
+
+  return false;
+}
+
+/**
+ * @brief Checks whether the parser is directly inside a record object.
+ *
+ * @return bool
+ *   True for values of record fields
+ */
+bool JsonStreamReader::inRecord() const {
+  return depth == 2;
+}
@@ -0,0 +1,81 @@
+// Standard library headers
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
+// Project headers
+#include "inputs/json_tail_reader.h"
+
+/**
+ * @brief Creates a reader for a JSON file.
+ *
+ * @param path
+ *   Path to the file
+ */
+JsonTailReader::JsonTailReader(const std::string& path) : path(path) {
+}
+
+/**
+ * @brief Reads the last records of the file.
+ *
+ * @param count
+ *   Number of records to read
+ *
+ * @return std::vector<Measurement>
+ *   Up to count records, oldest first
+ *
+ * @throws std::runtime_error
+ *   If the file cannot be opened or a record cannot be parsed
+ */
+std::vector<Measurement> JsonTailReader::readLast(size_t count) const {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    throw std::runtime_error("Cannot open file: " + path);
+  }
+
+  std::vector<Measurement> result;
+  std::string window;
+  size_t offset = file.tellg();
+
+  // The window always holds the not yet consumed bytes directly before the consumed tail.
+  while (result.size() < count && offset > 0) {
+    size_t size = std::min(offset, BLOCK_SIZE);
+    offset -= size;
+
+    std::string block(size, '\0');
+    file.seekg(offset);
+    if (!file.read(&block[0], size)) {
+      throw std::runtime_error("Failed to read file: " + path);
+    }
+    window.insert(0, block);
+
+    size_t close;
+    while (result.size() < count && (close = window.rfind('}')) != std::string::npos) {
+      size_t open = window.rfind('{', close);
+      if (open == std::string::npos) {
+        // The record starts in an earlier block.
+        break;
+      }
+
+      nlohmann::json rec;
+      try {
+        rec = nlohmann::json::parse(window.begin() + open, window.begin() + close + 1);
+      }
+      catch (...) {
+        throw std::runtime_error("Failed to parse JSON record in: " + path);
+      }
+
+      if (rec.contains("Component") && rec.contains("Temperature") && rec.contains("Timestamp")) {
+        result.push_back({rec["Component"], rec["Temperature"], rec["Timestamp"]});
+      }
+      window.erase(open);
+    }
+  }
+
+  std::reverse(result.begin(), result.end());
+
+  return result;
+}
@@ -0,0 +1,248 @@
+// Standard library headers
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <stdexcept>
+#include <utility>
+
+// Project headers
+#include "inputs/ohm_collector.h"
+#include "inputs/ohm_source.h"
+
+/**
+ * @brief Callback for cURL appending a chunk of a response to the buffer of its host.
+ *
+ * @param contents
+ *   Pointer to the received data
+ * @param size
+ *   Size of each data chunk
+ * @param nmemb
+ *   Number of data chunks
+ * @param output
+ *   Response buffer of the host
+ *
+ * @return size_t
+ *   Total size of data written
+ */
+static size_t appendResponse(void* contents, size_t size, size_t nmemb, std::string* output) {
+  size_t totalSize = size * nmemb;
+  output->append(static_cast<char*>(contents), totalSize);
+
+  return totalSize;
+}
+
+/**
+ * @brief Creates a handle for every host.
+ *
+ * @param hosts
+ *   URLs of the data.json endpoints by host name
+ * @param timeoutMs
+ *   Time in milliseconds a snapshot waits for the hosts to answer
+ *
+ * @throws std::runtime_error
+ *   If a cURL handle cannot be created
+ */
+OHMCollector::OHMCollector(const std::map<std::string, std::string>& hosts, int timeoutMs)
+    : multi(curl_multi_init()), timeoutMs(timeoutMs) {
+  if (!multi) {
+    throw std::runtime_error("cURL initialization failed");
+  }
+
+  // The handles point at the response buffers, so the vector must not reallocate later on.
+  this->hosts.reserve(hosts.size());
+  for (const auto& [name, url] : hosts) {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+      for (auto& host : this->hosts) {
+        curl_easy_cleanup(host.curl);
+      }
+      curl_multi_cleanup(multi);
+      throw std::runtime_error("cURL initialization failed");
+    }
+
+    Host& host =
+        this->hosts.emplace_back(Host{name, url, curl, std::string(), false, SensorPaths()});
+    host.response.reserve(RESPONSE_RESERVE);
+    curl_easy_setopt(curl, CURLOPT_URL, host.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, appendResponse);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &host.response);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, &host);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, REQUEST_TIMEOUT_MS);
+  }
+}
+
+/**
+ * @brief Aborts the requests in flight and releases the handles.
+ */
+OHMCollector::~OHMCollector() {
+  for (auto& host : hosts) {
+    if (host.pending) {
+      curl_multi_remove_handle(multi, host.curl);
+    }
+    curl_easy_cleanup(host.curl);
+  }
+  curl_multi_cleanup(multi);
+}
+
+/**
+ * @brief Method required by interface, but not implemented in OHMCollector.
+ *
+ * @param component
+ *   Required by interface; ignored in this implementation
+ *
+ * @return Measurement
+ *   Always throws std::runtime_error
+ */
+Measurement OHMCollector::getMeasurement(const std::string&) {
+  throw std::runtime_error(
+      "OHMCollector does not implement getMeasurement(). Use getSnapshot() instead.");
+}
+
+/**
+ * @brief Retrieves temperatures of several components from every host.
+ *
+ * Sends a request to every host without one in flight, then handles responses as they arrive
+ * until every request has finished or the timeout has passed.
+ *
+ * @param components
+ *   Names of the hardware components
+ * @param errors
+ *   Receives one message per host or host series that could not be measured
+ *
+ * @return std::vector<Measurement>
+ *   Measurements of the hosts that answered, named "<Component>@<Host>"
+ */
+std::vector<Measurement> OHMCollector::getSnapshot(const std::vector<std::string>& components,
+                                                   std::vector<std::string>& errors) {
+  std::vector<bool> started(hosts.size(), false);
+  for (size_t i = 0; i < hosts.size(); ++i) {
+    Host& host = hosts[i];
+    if (host.pending) {
+      errors.push_back(host.name + ": previous request still in flight");
+      continue;
+    }
+
+    host.response.clear();
+    CURLMcode code = curl_multi_add_handle(multi, host.curl);
+    if (code != CURLM_OK) {
+      errors.push_back(host.name + ": " + curl_multi_strerror(code));
+      continue;
+    }
+    host.pending = true;
+    started[i] = true;
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+  std::vector<Measurement> measurements;
+
+  while (true) {
+    int running = 0;
+    CURLMcode code = curl_multi_perform(multi, &running);
+    if (code != CURLM_OK) {
+      errors.push_back(std::string("cURL multi error: ") + curl_multi_strerror(code));
+      break;
+    }
+
+    int queued = 0;
+    while (CURLMsg* message = curl_multi_info_read(multi, &queued)) {
+      if (message->msg != CURLMSG_DONE) {
+        continue;
+      }
+
+      Host* host = nullptr;
+      curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, &host);
+      CURLcode result = message->data.result;
+      curl_multi_remove_handle(multi, message->easy_handle);
+      host->pending = false;
+      readResponse(*host, result, components, measurements, errors);
+    }
+
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+    if (running == 0 || remaining.count() <= 0) {
+      break;
+    }
+
+    code = curl_multi_poll(multi, nullptr, 0, static_cast<int>(std::min<long long>(
+                                                  remaining.count(), INT_MAX)),
+                           nullptr);
+    if (code != CURLM_OK) {
+      errors.push_back(std::string("cURL multi error: ") + curl_multi_strerror(code));
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < hosts.size(); ++i) {
+    if (started[i] && hosts[i].pending) {
+      errors.push_back(hosts[i].name + ": no response within " + std::to_string(timeoutMs) +
+                       " ms, collected on a later tick");
+    }
+  }
+
+  return measurements;
+}
+
+/**
+ * @brief Unsupported operation for OHMCollector.
+ *
+ * @param component
+ *   Ignored.
+ * @param count
+ *   Ignored.
+ * @param fromStart
+ *   Ignored.
+ *
+ * @throws std::runtime_error
+ */
+void OHMCollector::deleteMeasurements(const std::string&, int, bool) {
+  throw std::runtime_error("OHMCollector does not support deleteMeasurements().");
+}
+
+/**
+ * @brief Handles a finished request of a host.
+ *
+ * @param host
+ *   Host whose request finished
+ * @param result
+ *   Outcome of the transfer
+ * @param components
+ *   Names of the hardware components to read
+ * @param measurements
+ *   Receives the measurements of the host
+ * @param errors
+ *   Receives one message per failure
+ */
+void OHMCollector::readResponse(Host& host, CURLcode result,
+                                const std::vector<std::string>& components,
+                                std::vector<Measurement>& measurements,
+                                std::vector<std::string>& errors) {
+  if (result != CURLE_OK) {
+    errors.push_back(host.name + ": " + curl_easy_strerror(result));
+    return;
+  }
+
+  nlohmann::json jsonData;
+  try {
+    jsonData = nlohmann::json::parse(host.response);
+  }
+  catch (...) {
+    errors.push_back(host.name + ": Failed to parse OHM JSON data.");
+    return;
+  }
+
+  OHMData ohm(std::move(jsonData), &host.paths);
+  long long timestamp = ohm.getTimestamp();
+  for (const auto& component : components) {
+    std::string series = component + HOST_SEPARATOR + host.name;
+    try {
+      measurements.push_back(
+          Measurement{series, OHMSource::readTemperature(ohm, component), timestamp});
+    }
+    catch (const std::exception& e) {
+      errors.push_back(series + ": " + e.what());
+    }
+  }
+}
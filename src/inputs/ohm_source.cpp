@@ -1,5 +1,6 @@
 // Standard library headers
 #include <stdexcept>
+#include <utility>
 
 // Project headers
 #include "api/ohm_api.h"
@@ -20,7 +21,57 @@
  * @throws std::invalid_argument
  */
 Measurement OHMSource::getMeasurement(const std::string& component) {
-  std::string rawJson = fetchOHMData(OHM_URL);
+  OHMData ohm = fetchSnapshot();
+
+  return Measurement{component, readTemperature(ohm, component), ohm.getTimestamp()};
+}
+
+/**
+ * @brief Retrieves temperatures of several components from a single OHM document.
+ *
+ * The document is fetched and parsed once, so the readings come from the same instant and share
+ * its timestamp.
+ *
+ * @param components
+ *   Names of the hardware components.
+ * @param errors
+ *   Receives one message per component without a temperature.
+ *
+ * @return std::vector<Measurement>
+ *   Measurements sharing the timestamp of the document.
+ *
+ * @throws std::runtime_error
+ *   If the document cannot be fetched or parsed.
+ */
+std::vector<Measurement> OHMSource::getSnapshot(const std::vector<std::string>& components,
+                                                std::vector<std::string>& errors) {
+  OHMData ohm = fetchSnapshot();
+  long long timestamp = ohm.getTimestamp();
+
+  std::vector<Measurement> measurements;
+  measurements.reserve(components.size());
+  for (const auto& component : components) {
+    try {
+      measurements.push_back(Measurement{component, readTemperature(ohm, component), timestamp});
+    }
+    catch (const std::exception& e) {
+      errors.push_back(component + ": " + e.what());
+    }
+  }
+
+  return measurements;
+}
+
+/**
+ * @brief Fetches and parses the current OHM document.
+ *
+ * @return OHMData
+ *   Sensor readings stamped with the time of the fetch.
+ *
+ * @throws std::runtime_error
+ */
+OHMData OHMSource::fetchSnapshot() {
+  const std::string& rawJson = OHMFetcher::getInstance().fetch(OHM_URL);
   if (rawJson.empty()) {
     throw std::runtime_error("Failed to fetch data from OHM.");
   }
@@ -33,8 +84,24 @@ Measurement OHMSource::getMeasurement(const std::string& component) {
     throw std::runtime_error("Failed to parse OHM JSON data.");
   }
 
-  OHMData ohm(jsonData);
+  return OHMData(std::move(jsonData), &paths);
+}
 
+/**
+ * @brief Reads the temperature of a component from an OHM document.
+ *
+ * @param ohm
+ *   Sensor readings.
+ * @param component
+ *   The name of the hardware component.
+ *
+ * @return double
+ *   Temperature in Celsius.
+ *
+ * @throws std::runtime_error
+ * @throws std::invalid_argument
+ */
+double OHMSource::readTemperature(const OHMData& ohm, const std::string& component) {
   double temp = -1.0;
   if (component == "CPU") {
     temp = ohm.getCPUTemperature();
@@ -53,7 +120,7 @@ Measurement OHMSource::getMeasurement(const std::string& component) {
     throw std::runtime_error("Temperature data not found for: " + component);
   }
 
-  return Measurement{component, temp, ohm.getTimestamp()};
+  return temp;
 }
 
 /**
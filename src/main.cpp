@@ -6,25 +6,35 @@
 #include "cli.h"
 #include "config/config.h"
 #include "config/config_loader.h"
+#include "storage/storage_engine.h"
 
 /**
  * Main function - Fetches data from OHM and starts the CLI interface.
  */
 int main() {
-  std::string data = fetchOHMData(OHM_URL);
+  try {
+    ConfigLoader::loadConfig("../conf/components.conf");
+    ConfigLoader::validate();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Error loading configuration: " << e.what() << std::endl;
 
-  if (data.empty()) {
+    return 0;
+  }
+
+  // Remote hosts may be down at startup; they are reported on every tick instead.
+  if (ConfigLoader::OHM_HOSTS.empty() && fetchOHMData(OHM_URL).empty()) {
     std::cout << "Failed to retrieve data.\n";
 
     return 0;
   }
 
   try {
-    ConfigLoader::loadConfig("../conf/components.conf");
-    ConfigLoader::validate();
+    // Repairs the storage files and replays the write-ahead log before anything reads them.
+    StorageEngine::getInstance();
   }
   catch (const std::exception& e) {
-    std::cerr << "Error loading configuration: " << e.what() << std::endl;
+    std::cerr << "Error recovering storage: " << e.what() << std::endl;
 
     return 0;
   }
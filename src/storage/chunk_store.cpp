@@ -0,0 +1,879 @@
+// Standard library headers
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+// Project headers
+#include "storage/chunk_store.h"
+#include "storage/gorilla.h"
+#include "utils/utils.h"
+
+/**
+ * @brief Sparse index of a chunk file together with the file size it was built for.
+ */
+struct CachedIndex {
+  size_t fileSize;
+  std::shared_ptr<const std::vector<ChunkIndexEntry>> entries;
+};
+
+static std::mutex indexMutex;
+static std::unordered_map<std::string, CachedIndex> indexes;
+
+/**
+ * @brief Writes bytes to a file and syncs it.
+ *
+ * @param path
+ *   Path to the file
+ * @param bytes
+ *   Bytes to write
+ * @param flags
+ *   Flags passed to open(), e.g. O_APPEND or O_TRUNC
+ *
+ * @throws std::runtime_error
+ *   If the file cannot be written
+ */
+static void writeAndSync(const std::string& path, const std::string& bytes, int flags) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | flags, 0644);
+  if (fd == -1) {
+    throw std::runtime_error("Cannot open chunk file for writing: " + path);
+  }
+
+  size_t written = 0;
+  while (written < bytes.size()) {
+    ssize_t res = write(fd, bytes.data() + written, bytes.size() - written);
+    if (res <= 0) {
+      close(fd);
+      throw std::runtime_error("Failed to write chunk file: " + path);
+    }
+    written += res;
+  }
+
+  int res = fsync(fd);
+  close(fd);
+  if (res != 0) {
+    throw std::runtime_error("Cannot sync chunk file: " + path);
+  }
+}
+
+/**
+ * @brief Creates a store addressing the unpartitioned chunk files of older versions.
+ */
+ChunkStore::ChunkStore() : partitioned(false), partition(0) {
+}
+
+/**
+ * @brief Creates a store addressing one time partition of every component.
+ *
+ * @param partition
+ *   First timestamp covered by the partition
+ */
+ChunkStore::ChunkStore(int64_t partition) : partitioned(true), partition(partition) {
+}
+
+/**
+ * @brief Encodes measurements and appends them as new chunks, then syncs the file.
+ *
+ * @param series
+ *   Name of the component
+ * @param records
+ *   Measurements ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If the chunk file cannot be written
+ */
+void ChunkStore::append(const std::string& series, const std::vector<Measurement>& records) {
+  if (records.empty()) {
+    return;
+  }
+
+  if (partitioned) {
+    ensureDataDirectoryExists(getPartitionDirectory(series));
+  }
+
+  // A torn chunk at the tail would hide every chunk appended after it.
+  truncate(series, SIZE_MAX);
+
+  std::string path = getChunkPath(series);
+  struct stat info;
+  size_t base = stat(path.c_str(), &info) == 0 ? info.st_size : 0;
+  std::string chunks = encode(records);
+  writeAndSync(path, chunks, O_APPEND);
+
+  // The zone file is derived data; chunks it misses are covered again on recovery.
+  try {
+    writeAndSync(getZonePath(series), encodeZones(records, chunks, base), O_APPEND);
+  }
+  catch (const std::exception&) {
+  }
+  forgetIndex(path);
+}
+
+/**
+ * @brief Atomically replaces all chunks of the component.
+ *
+ * @param series
+ *   Name of the component
+ * @param records
+ *   Measurements ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If the chunk file cannot be written
+ */
+void ChunkStore::replace(const std::string& series, const std::vector<Measurement>& records) {
+  stage(series, records);
+  commitStaged(series);
+}
+
+/**
+ * @brief Writes and syncs a replacement of the chunk file next to it without installing it.
+ *
+ * @param series
+ *   Name of the component
+ * @param records
+ *   Measurements ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If the staged file cannot be written
+ */
+void ChunkStore::stage(const std::string& series, const std::vector<Measurement>& records) {
+  if (partitioned) {
+    ensureDataDirectoryExists(getPartitionDirectory(series));
+  }
+
+  std::string chunks = encode(records);
+  writeAndSync(getStagedPath(series), chunks, O_TRUNC);
+
+  try {
+    writeAndSync(getZonePath(series) + ".tmp", encodeZones(records, chunks, 0), O_TRUNC);
+  }
+  catch (const std::exception&) {
+  }
+}
+
+/**
+ * @brief Installs the staged replacement of the chunk file.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @throws std::runtime_error
+ *   If the staged file cannot be renamed
+ */
+void ChunkStore::commitStaged(const std::string& series) {
+  std::string path = getChunkPath(series);
+  std::string stagedPath = getStagedPath(series);
+
+  if (std::rename(stagedPath.c_str(), path.c_str()) != 0) {
+    std::remove(stagedPath.c_str());
+    throw std::runtime_error("Failed to replace chunk file: " + path);
+  }
+
+  std::string zonePath = getZonePath(series);
+  if (std::rename((zonePath + ".tmp").c_str(), zonePath.c_str()) != 0) {
+    std::remove(zonePath.c_str());
+  }
+  forgetIndex(path);
+}
+
+/**
+ * @brief Finishes or discards a replacement interrupted by a crash.
+ *
+ * @param series
+ *   Name of the component
+ * @param expected
+ *   Number of measurements the chunk file is known to hold
+ *
+ * @throws std::runtime_error
+ *   If the staged file cannot be renamed
+ */
+void ChunkStore::recoverStaged(const std::string& series, size_t expected) {
+  std::string stagedPath = getStagedPath(series);
+  if (access(stagedPath.c_str(), F_OK) != 0) {
+    return;
+  }
+
+  // The staged file only counts once the new size was recorded.
+  if (countFile(stagedPath) == expected) {
+    commitStaged(series);
+  }
+  else {
+    std::remove(stagedPath.c_str());
+    std::remove((getZonePath(series) + ".tmp").c_str());
+  }
+}
+
+/**
+ * @brief Gets number of measurements stored in complete chunks.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return size_t
+ *   Number of measurements, 0 if the component has no chunks
+ */
+size_t ChunkStore::count(const std::string& series) const {
+  return countFile(getChunkPath(series));
+}
+
+/**
+ * @brief Decodes measurements in the range [begin, end), one chunk at a time.
+ *
+ * @param series
+ *   Name of the component
+ * @param begin
+ *   Position of the first measurement to read
+ * @param end
+ *   Position one past the last measurement to read
+ * @param out
+ *   Vector receiving the measurements
+ *
+ * @throws std::runtime_error
+ *   If a chunk is corrupted
+ */
+void ChunkStore::read(const std::string& series, size_t begin, size_t end,
+                      std::vector<Measurement>& out) const {
+  std::string path = getChunkPath(series);
+  if (begin >= end || access(path.c_str(), F_OK) != 0) {
+    return;
+  }
+
+  MappedFile file(path);
+  size_t position = 0;
+  size_t offset = 0;
+  ChunkHeader header;
+
+  while (position < end && nextChunk(file, offset, header)) {
+    const char* payload = file.data() + offset + sizeof(ChunkHeader);
+    offset += chunkSize(header);
+    if (position + header.count <= begin) {
+      position += header.count;
+      continue;
+    }
+
+    if (computeChecksum(payload, header.payloadSize) != header.checksum) {
+      throw std::runtime_error("Corrupted chunk in: " + path);
+    }
+
+    GorillaDecoder decoder(payload, header.payloadSize, header.count);
+    int64_t timestamp;
+    double temperature;
+    while (position < end && decoder.next(timestamp, temperature)) {
+      if (position >= begin) {
+        out.push_back({series, temperature, timestamp});
+      }
+      ++position;
+    }
+  }
+}
+
+/**
+ * @brief Decodes measurements with timestamps in the range [begin, end).
+ *
+ * @param series
+ *   Name of the component
+ * @param count
+ *   Number of measurements the file is known to hold; later ones are ignored
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ * @param out
+ *   Vector receiving the measurements, ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a chunk is corrupted
+ */
+void ChunkStore::readRange(const std::string& series, size_t count, int64_t begin, int64_t end,
+                           std::vector<Measurement>& out) const {
+  readMatching(series, count, begin, end, -std::numeric_limits<double>::infinity(),
+               std::numeric_limits<double>::infinity(), out);
+}
+
+/**
+ * @brief Decodes measurements with timestamps in the range [begin, end) from the chunks whose zone
+ * may hold temperatures within [low, high].
+ *
+ * Temperatures are not filtered per measurement, so the caller can number measurements sharing a
+ * timestamp before filtering.
+ *
+ * @param series
+ *   Name of the component
+ * @param count
+ *   Number of measurements the file is known to hold; later ones are ignored
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ * @param low
+ *   Lowest matching temperature
+ * @param high
+ *   Highest matching temperature
+ * @param out
+ *   Vector receiving the measurements, ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a chunk is corrupted
+ */
+void ChunkStore::readMatching(const std::string& series, size_t count, int64_t begin, int64_t end,
+                              double low, double high, std::vector<Measurement>& out) const {
+  std::string path = getChunkPath(series);
+  if (count == 0 || begin >= end || access(path.c_str(), F_OK) != 0) {
+    return;
+  }
+
+  MappedFile file(path);
+  auto index = getIndex(path, file);
+  auto chunk = std::partition_point(index->begin(), index->end(), [&](const ChunkIndexEntry& e) {
+    return e.lastTimestamp < begin;
+  });
+
+  for (; chunk != index->end() && chunk->firstTimestamp < end && chunk->position < count;
+       ++chunk) {
+    // A timestamp spanning two chunks must be read whole, or the sequences of its records shift
+    auto next = chunk + 1;
+    bool shared =
+        (chunk != index->begin() && (chunk - 1)->lastTimestamp == chunk->firstTimestamp) ||
+        (next != index->end() && next->firstTimestamp == chunk->lastTimestamp);
+    if (chunk->zoned && !shared &&
+        (chunk->maxTemperature < low || chunk->minTemperature > high)) {
+      continue;
+    }
+
+    ChunkHeader header;
+    nextChunk(file, chunk->offset, header);
+    const char* payload = file.data() + chunk->offset + sizeof(ChunkHeader);
+    if (computeChecksum(payload, header.payloadSize) != header.checksum) {
+      throw std::runtime_error("Corrupted chunk in: " + path);
+    }
+
+    GorillaDecoder decoder(payload, header.payloadSize, header.count);
+    size_t position = chunk->position;
+    int64_t timestamp;
+    double temperature;
+    while (position < count && decoder.next(timestamp, temperature) && timestamp < end) {
+      if (timestamp >= begin) {
+        out.push_back({series, temperature, timestamp});
+      }
+      ++position;
+    }
+  }
+}
+
+/**
+ * @brief Writes the zone file of a chunk file whose chunks are not all covered by it.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @throws std::runtime_error
+ *   If a chunk is corrupted or the zone file cannot be written
+ */
+void ChunkStore::buildZones(const std::string& series) {
+  std::string path = getChunkPath(series);
+  if (access(path.c_str(), F_OK) != 0) {
+    return;
+  }
+
+  MappedFile file(path);
+  auto zones = loadZones(getZonePath(series));
+  std::string bytes;
+  bool complete = true;
+  size_t offset = 0;
+  ChunkHeader header;
+
+  while (nextChunk(file, offset, header)) {
+    auto zone = zones.find(offset);
+    if (zone != zones.end() && zone->second.checksum == header.checksum) {
+      bytes.append(reinterpret_cast<const char*>(&zone->second), sizeof(ChunkZone));
+      offset += chunkSize(header);
+      continue;
+    }
+
+    const char* payload = file.data() + offset + sizeof(ChunkHeader);
+    if (computeChecksum(payload, header.payloadSize) != header.checksum) {
+      throw std::runtime_error("Corrupted chunk in: " + path);
+    }
+
+    ChunkZone entry{offset, header.checksum, 0, std::numeric_limits<double>::infinity(),
+                    -std::numeric_limits<double>::infinity()};
+    GorillaDecoder decoder(payload, header.payloadSize, header.count);
+    int64_t timestamp;
+    double temperature;
+    while (decoder.next(timestamp, temperature)) {
+      entry.minTemperature = std::min(entry.minTemperature, temperature);
+      entry.maxTemperature = std::max(entry.maxTemperature, temperature);
+    }
+    bytes.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    offset += chunkSize(header);
+    complete = false;
+  }
+
+  if (!complete) {
+    writeFileDurably(getZonePath(series), bytes);
+    forgetIndex(path);
+  }
+}
+
+/**
+ * @brief Decodes the last measurements by walking chunks backwards from the end of the file.
+ *
+ * @param series
+ *   Name of the component
+ * @param count
+ *   Number of measurements to read
+ * @param out
+ *   Vector receiving the measurements, oldest first
+ *
+ * @return bool
+ *   False if the file cannot be walked backwards, e.g. after a torn write; out is then unchanged
+ *
+ * @throws std::runtime_error
+ *   If a chunk is corrupted
+ */
+bool ChunkStore::readLast(const std::string& series, size_t count,
+                          std::vector<Measurement>& out) const {
+  std::string path = getChunkPath(series);
+  if (count == 0 || access(path.c_str(), F_OK) != 0) {
+    return true;
+  }
+
+  MappedFile file(path);
+
+  // Collect offsets of the newest chunks until they hold enough measurements.
+  std::vector<size_t> offsets;
+  size_t available = 0;
+  size_t end = file.size();
+  while (end > 0 && available < count) {
+    uint32_t size;
+    if (end < sizeof(ChunkHeader) + sizeof(size)) {
+      return false;
+    }
+
+    std::memcpy(&size, file.data() + end - sizeof(size), sizeof(size));
+    ChunkHeader header;
+    if (size > end || !nextChunk(file, end - size, header) || chunkSize(header) != size) {
+      return false;
+    }
+
+    end -= size;
+    offsets.push_back(end);
+    available += header.count;
+  }
+
+  size_t skip = available > count ? available - count : 0;
+  for (auto it = offsets.rbegin(); it != offsets.rend(); ++it) {
+    ChunkHeader header;
+    nextChunk(file, *it, header);
+    const char* payload = file.data() + *it + sizeof(ChunkHeader);
+    if (computeChecksum(payload, header.payloadSize) != header.checksum) {
+      throw std::runtime_error("Corrupted chunk in: " + path);
+    }
+
+    GorillaDecoder decoder(payload, header.payloadSize, header.count);
+    int64_t timestamp;
+    double temperature;
+    while (decoder.next(timestamp, temperature)) {
+      if (skip > 0) {
+        --skip;
+        continue;
+      }
+      out.push_back({series, temperature, timestamp});
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Drops chunks past the given number of measurements.
+ *
+ * @param series
+ *   Name of the component
+ * @param count
+ *   Number of measurements to keep; chunks are dropped whole
+ *
+ * @throws std::runtime_error
+ *   If the chunk file cannot be truncated
+ */
+void ChunkStore::truncate(const std::string& series, size_t count) {
+  std::string path = getChunkPath(series);
+  if (access(path.c_str(), F_OK) != 0) {
+    return;
+  }
+
+  size_t total = 0;
+  size_t keep = 0;
+  size_t fileSize;
+  {
+    MappedFile file(path);
+    fileSize = file.size();
+    ChunkHeader header;
+    while (nextChunk(file, keep, header) && total + header.count <= count) {
+      total += header.count;
+      keep += chunkSize(header);
+    }
+  }
+
+  if (keep < fileSize && ::truncate(path.c_str(), keep) != 0) {
+    throw std::runtime_error("Cannot truncate chunk file: " + path);
+  }
+  forgetIndex(path);
+}
+
+/**
+ * @brief Removes the chunk file of the component.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @throws std::runtime_error
+ *   If the file exists and cannot be removed
+ */
+void ChunkStore::remove(const std::string& series) {
+  std::string path = getChunkPath(series);
+  if (std::remove(path.c_str()) != 0 && access(path.c_str(), F_OK) == 0) {
+    throw std::runtime_error("Cannot remove chunk file: " + path);
+  }
+  std::remove(getZonePath(series).c_str());
+  forgetIndex(path);
+}
+
+/**
+ * @brief Gets time partitions of a component that have a chunk file or a staged replacement.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return std::vector<int64_t>
+ *   First timestamps of the partitions, in ascending order
+ */
+std::vector<int64_t> ChunkStore::listPartitions(const std::string& series) {
+  std::vector<int64_t> partitions;
+  std::string extension = CHUNK_EXTENSION;
+  DIR* dir = opendir(getPartitionDirectory(series).c_str());
+  if (!dir) {
+    return partitions;
+  }
+
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    size_t dot = name.find('.');
+    if (dot == 0 || dot == std::string::npos) {
+      continue;
+    }
+
+    std::string suffix = name.substr(dot);
+    if (suffix != extension && suffix != extension + ".tmp") {
+      continue;
+    }
+
+    try {
+      partitions.push_back(std::stoll(name.substr(0, dot)));
+    }
+    catch (const std::exception&) {
+      continue;
+    }
+  }
+  closedir(dir);
+
+  std::sort(partitions.begin(), partitions.end());
+  partitions.erase(std::unique(partitions.begin(), partitions.end()), partitions.end());
+
+  return partitions;
+}
+
+/**
+ * @brief Gets path to the directory holding the partitions of a component.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return std::string
+ *   Full path to the partition directory
+ */
+std::string ChunkStore::getPartitionDirectory(const std::string& series) {
+  return getDataDirectory() + "/segments/" + series;
+}
+
+/**
+ * @brief Gets path to the chunk file of a component.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return std::string
+ *   Full path to the chunk file
+ */
+std::string ChunkStore::getChunkPath(const std::string& series) const {
+  if (partitioned) {
+    return getPartitionDirectory(series) + "/" + std::to_string(partition) + CHUNK_EXTENSION;
+  }
+
+  return getDataDirectory() + "/segments/" + series + CHUNK_EXTENSION;
+}
+
+/**
+ * @brief Gets path to the zone file of a component.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return std::string
+ *   Full path to the zone file
+ */
+std::string ChunkStore::getZonePath(const std::string& series) const {
+  if (partitioned) {
+    return getPartitionDirectory(series) + "/" + std::to_string(partition) + ZONE_EXTENSION;
+  }
+
+  return getDataDirectory() + "/segments/" + series + ZONE_EXTENSION;
+}
+
+/**
+ * @brief Gets path to the staged replacement of the chunk file of a component.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return std::string
+ *   Full path to the staged file
+ */
+std::string ChunkStore::getStagedPath(const std::string& series) const {
+  return getChunkPath(series) + ".tmp";
+}
+
+/**
+ * @brief Encodes measurements into chunks of at most CHUNK_RECORDS measurements.
+ *
+ * @param records
+ *   Measurements ordered by timestamp
+ *
+ * @return std::string
+ *   Bytes of the encoded chunks
+ */
+std::string ChunkStore::encode(const std::vector<Measurement>& records) {
+  std::string bytes;
+
+  for (size_t begin = 0; begin < records.size(); begin += CHUNK_RECORDS) {
+    size_t end = std::min(begin + CHUNK_RECORDS, records.size());
+
+    GorillaEncoder encoder;
+    for (size_t i = begin; i < end; ++i) {
+      encoder.append(records[i].timestamp, records[i].temperature);
+    }
+    const std::string& payload = encoder.getBytes();
+
+    ChunkHeader header{{'H', 'C', 'H', 'K'},
+                       encoder.getCount(),
+                       records[begin].timestamp,
+                       records[end - 1].timestamp,
+                       static_cast<uint32_t>(payload.size()),
+                       computeChecksum(payload.data(), payload.size())};
+    uint32_t trailer = chunkSize(header);
+
+    bytes.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(payload);
+    bytes.append(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+  }
+
+  return bytes;
+}
+
+/**
+ * @brief Builds the zone entries of chunks produced by encode().
+ *
+ * @param records
+ *   Measurements passed to encode()
+ * @param chunks
+ *   Bytes returned by encode()
+ * @param base
+ *   Offset the chunks are written at
+ *
+ * @return std::string
+ *   Bytes of the zone entries, one per chunk
+ */
+std::string ChunkStore::encodeZones(const std::vector<Measurement>& records,
+                                    const std::string& chunks, size_t base) {
+  std::string bytes;
+  size_t offset = 0;
+
+  for (size_t begin = 0; begin < records.size(); begin += CHUNK_RECORDS) {
+    size_t end = std::min(begin + CHUNK_RECORDS, records.size());
+
+    ChunkHeader header;
+    std::memcpy(&header, chunks.data() + offset, sizeof(header));
+    ChunkZone zone{base + offset, header.checksum, 0, records[begin].temperature,
+                   records[begin].temperature};
+    for (size_t i = begin + 1; i < end; ++i) {
+      zone.minTemperature = std::min(zone.minTemperature, records[i].temperature);
+      zone.maxTemperature = std::max(zone.maxTemperature, records[i].temperature);
+    }
+
+    bytes.append(reinterpret_cast<const char*>(&zone), sizeof(zone));
+    offset += chunkSize(header);
+  }
+
+  return bytes;
+}
+
+/**
+ * @brief Reads the zone file of a chunk file.
+ *
+ * A torn last entry is ignored.
+ *
+ * @param path
+ *   Path to the zone file
+ *
+ * @return std::unordered_map<uint64_t, ChunkZone>
+ *   Zone entries by chunk offset, later entries replacing earlier ones
+ */
+std::unordered_map<uint64_t, ChunkZone> ChunkStore::loadZones(const std::string& path) {
+  std::unordered_map<uint64_t, ChunkZone> zones;
+  if (access(path.c_str(), F_OK) != 0) {
+    return zones;
+  }
+
+  MappedFile file(path);
+  for (size_t offset = 0; offset + sizeof(ChunkZone) <= file.size(); offset += sizeof(ChunkZone)) {
+    ChunkZone zone;
+    std::memcpy(&zone, file.data() + offset, sizeof(zone));
+    zones[zone.offset] = zone;
+  }
+
+  return zones;
+}
+
+/**
+ * @brief Gets number of measurements stored in complete chunks of a file.
+ *
+ * @param path
+ *   Path to the chunk file
+ *
+ * @return size_t
+ *   Number of measurements, 0 if the file does not exist
+ */
+size_t ChunkStore::countFile(const std::string& path) const {
+  if (access(path.c_str(), F_OK) != 0) {
+    return 0;
+  }
+
+  MappedFile file(path);
+  size_t total = 0;
+  size_t offset = 0;
+  ChunkHeader header;
+  while (nextChunk(file, offset, header)) {
+    total += header.count;
+    offset += chunkSize(header);
+  }
+
+  return total;
+}
+
+/**
+ * @brief Reads the chunk header at an offset and checks the chunk lies entirely within the file.
+ *
+ * @param file
+ *   Mapped chunk file
+ * @param offset
+ *   Offset of a chunk boundary
+ * @param header
+ *   Receives the chunk header
+ *
+ * @return bool
+ *   False at the end of the file or at a torn or invalid chunk
+ */
+bool ChunkStore::nextChunk(const MappedFile& file, size_t offset, ChunkHeader& header) const {
+  header.count = 0;
+  if (offset + sizeof(ChunkHeader) > file.size()) {
+    return false;
+  }
+
+  std::memcpy(&header, file.data() + offset, sizeof(header));
+  if (std::memcmp(header.magic, "HCHK", 4) != 0 || offset + chunkSize(header) > file.size()) {
+    header.count = 0;
+
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Gets the sparse index of a chunk file, building it if the file changed since.
+ *
+ * Only the chunk headers and the zone file are read; a torn chunk ends the index like it ends
+ * every other walk.
+ *
+ * @param path
+ *   Path to the chunk file
+ * @param file
+ *   Mapping of the chunk file
+ *
+ * @return std::shared_ptr<const std::vector<ChunkIndexEntry>>
+ *   One entry per complete chunk, ordered by offset
+ */
+std::shared_ptr<const std::vector<ChunkIndexEntry>>
+ChunkStore::getIndex(const std::string& path, const MappedFile& file) const {
+  std::lock_guard<std::mutex> lock(indexMutex);
+  auto cached = indexes.find(path);
+  if (cached != indexes.end() && cached->second.fileSize == file.size()) {
+    return cached->second.entries;
+  }
+
+  std::string extension = CHUNK_EXTENSION;
+  auto zones = loadZones(path.substr(0, path.size() - extension.size()) + ZONE_EXTENSION);
+
+  auto entries = std::make_shared<std::vector<ChunkIndexEntry>>();
+  size_t position = 0;
+  size_t offset = 0;
+  ChunkHeader header;
+  while (nextChunk(file, offset, header)) {
+    ChunkIndexEntry entry{header.firstTimestamp, header.lastTimestamp, position, offset, 0.0, 0.0,
+                          false};
+    auto zone = zones.find(offset);
+    if (zone != zones.end() && zone->second.checksum == header.checksum) {
+      entry.minTemperature = zone->second.minTemperature;
+      entry.maxTemperature = zone->second.maxTemperature;
+      entry.zoned = true;
+    }
+    entries->push_back(entry);
+    position += header.count;
+    offset += chunkSize(header);
+  }
+  indexes[path] = {file.size(), entries};
+
+  return entries;
+}
+
+/**
+ * @brief Drops the cached sparse index of a chunk file.
+ *
+ * @param path
+ *   Path to the chunk file
+ */
+void ChunkStore::forgetIndex(const std::string& path) {
+  std::lock_guard<std::mutex> lock(indexMutex);
+  indexes.erase(path);
+}
+
+/**
+ * @brief Gets size of a whole chunk including its header and trailer.
+ *
+ * @param header
+ *   Header of the chunk
+ *
+ * @return size_t
+ *   Size in bytes
+ */
+size_t ChunkStore::chunkSize(const ChunkHeader& header) {
+  return sizeof(ChunkHeader) + header.payloadSize + sizeof(uint32_t);
+}
@@ -0,0 +1,362 @@
+// Standard library headers
+#include <cstring>
+#include <stdexcept>
+
+// Project headers
+#include "storage/gorilla.h"
+
+/**
+ * @brief Reinterprets a double as its IEEE 754 bit pattern.
+ *
+ * @param value
+ *   Value to convert
+ *
+ * @return uint64_t
+ *   Bit pattern of the value
+ */
+static uint64_t toBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  return bits;
+}
+
+/**
+ * @brief Reinterprets an IEEE 754 bit pattern as a double.
+ *
+ * @param bits
+ *   Bit pattern to convert
+ *
+ * @return double
+ *   Value with the given bit pattern
+ */
+static double fromBits(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+
+  return value;
+}
+
+/**
+ * @brief Sign-extends a two's complement value stored on a number of bits.
+ *
+ * @param value
+ *   Raw bits
+ * @param bits
+ *   Width of the stored value
+ *
+ * @return int64_t
+ *   Signed value
+ */
+static int64_t signExtend(uint64_t value, int bits) {
+  uint64_t sign = 1ULL << (bits - 1);
+
+  return static_cast<int64_t>((value ^ sign) - sign);
+}
+
+/**
+ * @brief Creates an empty writer.
+ */
+BitWriter::BitWriter() : freeBits(0) {
+}
+
+/**
+ * @brief Writes a single bit.
+ *
+ * @param bit
+ *   Bit to write
+ */
+void BitWriter::writeBit(bool bit) {
+  if (freeBits == 0) {
+    bytes.push_back('\0');
+    freeBits = 8;
+  }
+
+  --freeBits;
+  if (bit) {
+    bytes.back() = static_cast<char>(bytes.back() | (1 << freeBits));
+  }
+}
+
+/**
+ * @brief Writes the lowest bits of a value, most significant first.
+ *
+ * @param value
+ *   Value whose bits are written
+ * @param count
+ *   Number of bits to write (0-64)
+ */
+void BitWriter::writeBits(uint64_t value, int count) {
+  while (count > 0) {
+    if (freeBits == 0) {
+      bytes.push_back('\0');
+      freeBits = 8;
+    }
+
+    int chunk = count < freeBits ? count : freeBits;
+    uint64_t part = (value >> (count - chunk)) & ((1ULL << chunk) - 1);
+    bytes.back() = static_cast<char>(bytes.back() | (part << (freeBits - chunk)));
+    freeBits -= chunk;
+    count -= chunk;
+  }
+}
+
+/**
+ * @brief Gets the written bytes, the last byte padded with zero bits.
+ *
+ * @return const std::string&
+ *   Encoded bytes
+ */
+const std::string& BitWriter::getBytes() const {
+  return bytes;
+}
+
+/**
+ * @brief Creates a reader over an existing buffer.
+ *
+ * @param data
+ *   Pointer to the first byte
+ * @param size
+ *   Number of bytes
+ */
+BitReader::BitReader(const char* data, size_t size)
+    : data(reinterpret_cast<const uint8_t*>(data)), size(size), position(0) {
+}
+
+/**
+ * @brief Reads a single bit.
+ *
+ * @return bool
+ *   Bit value
+ *
+ * @throws std::runtime_error
+ *   If the buffer is exhausted
+ */
+bool BitReader::readBit() {
+  if (position >= size * 8) {
+    throw std::runtime_error("Unexpected end of compressed data.");
+  }
+
+  bool bit = (data[position / 8] >> (7 - position % 8)) & 1;
+  ++position;
+
+  return bit;
+}
+
+/**
+ * @brief Reads a value stored on a number of bits.
+ *
+ * @param count
+ *   Number of bits to read (0-64)
+ *
+ * @return uint64_t
+ *   Value made of the read bits
+ *
+ * @throws std::runtime_error
+ *   If the buffer is exhausted
+ */
+uint64_t BitReader::readBits(int count) {
+  if (position + count > size * 8) {
+    throw std::runtime_error("Unexpected end of compressed data.");
+  }
+
+  uint64_t value = 0;
+  while (count > 0) {
+    int available = 8 - position % 8;
+    int chunk = count < available ? count : available;
+    uint64_t part = (data[position / 8] >> (available - chunk)) & ((1U << chunk) - 1);
+    value = (value << chunk) | part;
+    position += chunk;
+    count -= chunk;
+  }
+
+  return value;
+}
+
+/**
+ * @brief Creates an empty encoder.
+ */
+GorillaEncoder::GorillaEncoder()
+    : count(0), prevTimestamp(0), prevDelta(0), prevValue(0), prevLeading(-1), prevTrailing(0) {
+}
+
+/**
+ * @brief Appends a sample.
+ *
+ * Delta-of-delta buckets: '0' for no change, then '10', '110' and '1110' followed by a 7, 9 or
+ * 12 bit value, and '1111' followed by the full 64 bits.
+ *
+ * @param timestamp
+ *   Timestamp of the sample
+ * @param value
+ *   Value of the sample
+ */
+void GorillaEncoder::append(int64_t timestamp, double value) {
+  uint64_t bits = toBits(value);
+
+  if (count == 0) {
+    writer.writeBits(static_cast<uint64_t>(timestamp), 64);
+    writer.writeBits(bits, 64);
+    prevTimestamp = timestamp;
+    prevValue = bits;
+    ++count;
+
+    return;
+  }
+
+  int64_t delta = timestamp - prevTimestamp;
+  int64_t dod = delta - prevDelta;
+  if (dod == 0) {
+    writer.writeBit(false);
+  }
+  else if (dod >= -64 && dod <= 63) {
+    writer.writeBits(0b10, 2);
+    writer.writeBits(static_cast<uint64_t>(dod), 7);
+  }
+  else if (dod >= -256 && dod <= 255) {
+    writer.writeBits(0b110, 3);
+    writer.writeBits(static_cast<uint64_t>(dod), 9);
+  }
+  else if (dod >= -2048 && dod <= 2047) {
+    writer.writeBits(0b1110, 4);
+    writer.writeBits(static_cast<uint64_t>(dod), 12);
+  }
+  else {
+    writer.writeBits(0b1111, 4);
+    writer.writeBits(static_cast<uint64_t>(dod), 64);
+  }
+
+  uint64_t xorValue = bits ^ prevValue;
+  if (xorValue == 0) {
+    writer.writeBit(false);
+  }
+  else {
+    writer.writeBit(true);
+    int leading = __builtin_clzll(xorValue);
+    int trailing = __builtin_ctzll(xorValue);
+    if (leading > 31) {
+      leading = 31;
+    }
+
+    if (prevLeading != -1 && leading >= prevLeading && trailing >= prevTrailing) {
+      writer.writeBit(false);
+      writer.writeBits(xorValue >> prevTrailing, 64 - prevLeading - prevTrailing);
+    }
+    else {
+      int meaningful = 64 - leading - trailing;
+      writer.writeBit(true);
+      writer.writeBits(leading, 5);
+      writer.writeBits(meaningful & 63, 6);
+      writer.writeBits(xorValue >> trailing, meaningful);
+      prevLeading = leading;
+      prevTrailing = trailing;
+    }
+  }
+
+  prevDelta = delta;
+  prevTimestamp = timestamp;
+  prevValue = bits;
+  ++count;
+}
+
+/**
+ * @brief Gets number of appended samples.
+ *
+ * @return uint32_t
+ *   Number of samples
+ */
+uint32_t GorillaEncoder::getCount() const {
+  return count;
+}
+
+/**
+ * @brief Gets the encoded samples.
+ *
+ * @return const std::string&
+ *   Encoded bytes
+ */
+const std::string& GorillaEncoder::getBytes() const {
+  return writer.getBytes();
+}
+
+/**
+ * @brief Creates a decoder over encoded bytes.
+ *
+ * @param data
+ *   Pointer to the encoded bytes
+ * @param size
+ *   Number of encoded bytes
+ * @param count
+ *   Number of samples stored in the bytes
+ */
+GorillaDecoder::GorillaDecoder(const char* data, size_t size, uint32_t count)
+    : reader(data, size), remaining(count), decoded(0), prevTimestamp(0), prevDelta(0),
+      prevValue(0), prevLeading(0), prevTrailing(0) {
+}
+
+/**
+ * @brief Decodes the next sample.
+ *
+ * @param timestamp
+ *   Receives timestamp of the sample
+ * @param value
+ *   Receives value of the sample
+ *
+ * @return bool
+ *   False when all samples have been decoded
+ *
+ * @throws std::runtime_error
+ *   If the encoded bytes are truncated
+ */
+bool GorillaDecoder::next(int64_t& timestamp, double& value) {
+  if (remaining == 0) {
+    return false;
+  }
+
+  if (decoded == 0) {
+    prevTimestamp = static_cast<int64_t>(reader.readBits(64));
+    prevValue = reader.readBits(64);
+  }
+  else {
+    int64_t dod;
+    if (!reader.readBit()) {
+      dod = 0;
+    }
+    else if (!reader.readBit()) {
+      dod = signExtend(reader.readBits(7), 7);
+    }
+    else if (!reader.readBit()) {
+      dod = signExtend(reader.readBits(9), 9);
+    }
+    else if (!reader.readBit()) {
+      dod = signExtend(reader.readBits(12), 12);
+    }
+    else {
+      dod = static_cast<int64_t>(reader.readBits(64));
+    }
+
+    prevDelta += dod;
+    prevTimestamp += prevDelta;
+
+    if (reader.readBit()) {
+      if (reader.readBit()) {
+        prevLeading = reader.readBits(5);
+        int meaningful = reader.readBits(6);
+        if (meaningful == 0) {
+          meaningful = 64;
+        }
+        prevTrailing = 64 - prevLeading - meaningful;
+      }
+
+      int meaningful = 64 - prevLeading - prevTrailing;
+      prevValue ^= reader.readBits(meaningful) << prevTrailing;
+    }
+  }
+
+  timestamp = prevTimestamp;
+  value = fromBits(prevValue);
+  --remaining;
+  ++decoded;
+
+  return true;
+}
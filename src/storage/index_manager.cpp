@@ -1,11 +1,51 @@
 // Standard library headers
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
 
 // Project headers
 #include "storage/index_manager.h"
 #include "utils/utils.h"
 
+/**
+ * @brief Header of the binary index snapshot.
+ */
+struct IndexFileHeader {
+  char magic[4];
+  uint32_t components;
+  uint64_t generation;
+};
+
+/**
+ * @brief Header preceding the name and the timestamps of a component in the snapshot.
+ */
+struct IndexComponentHeader {
+  uint32_t nameLength;
+  uint32_t reserved;
+  uint64_t count;
+};
+
+static constexpr char INDEX_MAGIC[4] = {'H', 'I', 'D', 'X'};
+
+/**
+ * @brief Rounds a size up to the alignment of the timestamp arrays.
+ *
+ * @param size
+ *   Size in bytes
+ *
+ * @return size_t
+ *   Next multiple of 8
+ */
+static size_t alignTimestamps(size_t size) {
+  return (size + sizeof(int64_t) - 1) / sizeof(int64_t) * sizeof(int64_t);
+}
+
 /**
  * @brief Gets the singleton instance of IndexManager.
  *
@@ -21,12 +61,12 @@ IndexManager& IndexManager::getInstance() {
 /**
  * @brief Constructor loads existing index from file.
  */
-IndexManager::IndexManager() {
+IndexManager::IndexManager() : journalEntries(0), generation(0) {
   loadIndex();
 }
 
 /**
- * @brief Adds new timestamp to component's index and saves to file.
+ * @brief Adds new timestamp to component's index and records it in the journal.
  *
  * @param component
  *   Name of the hardware component (GPU/CPU/Motherboard)
@@ -34,138 +74,589 @@ IndexManager::IndexManager() {
  *   Unix timestamp of the measurement
  */
 void IndexManager::addIndex(const std::string& component, long long timestamp) {
-  auto& timestamps = index[component];
-  timestamps.push_back(timestamp);
-  std::sort(timestamps.begin(), timestamps.end());
-  saveIndex();
+  std::lock_guard<std::mutex> lock(mutex);
+  applyChange('a', component, timestamp);
+  logChange('a', component, timestamp);
+  publishLocked();
 }
 
 /**
- * @brief Gets all timestamps for specified component.
+ * @brief Gets a snapshot of the timestamps of specified component without copying them.
+ *
+ * The published map is loaded atomically, so readers never wait for writers.
  *
  * @param component
  *   Name of the hardware component
  *
- * @return vector<long long>
- *   Vector of timestamps sorted in ascending order
+ * @return Snapshot
+ *   Timestamps sorted in ascending order, empty if the component has none
  */
-std::vector<long long> IndexManager::getTimestamps(const std::string& component) const {
-  auto it = index.find(component);
-  if (it != index.end()) {
-    return it->second;
+IndexManager::Snapshot IndexManager::getSnapshot(const std::string& component) const {
+  auto components = std::atomic_load(&published);
+  if (components) {
+    auto it = components->find(component);
+    if (it != components->end()) {
+      return it->second;
+    }
   }
 
   return {};
 }
 
 /**
- * @brief Gets most recent timestamps for specified component.
+ * @brief Gets timestamps within the range [from, to) for specified component.
  *
  * @param component
  *   Name of the hardware component
- * @param count
- *   Number of timestamps to return
+ * @param from
+ *   First timestamp of the range
+ * @param to
+ *   Timestamp one past the range
  *
  * @return vector<long long>
- *   Vector of latest timestamps, sorted in ascending order
+ *   Vector of timestamps, sorted in ascending order
  */
-std::vector<long long> IndexManager::getLatestTimestamps(const std::string& component,
-                                                         size_t count) const {
-  auto timestamps = getTimestamps(component);
-  if (timestamps.empty())
+std::vector<long long> IndexManager::getRange(const std::string& component, long long from,
+                                              long long to) const {
+  if (from >= to)
     return {};
 
-  auto start = timestamps.size() > count ? timestamps.end() - count : timestamps.begin();
+  Snapshot snapshot = getSnapshot(component);
+  const long long* end = snapshot.data + snapshot.count;
+  const long long* first = std::lower_bound(snapshot.data, end, from);
+  const long long* last = std::lower_bound(first, end, to);
 
-  return std::vector<long long>(start, timestamps.end());
+  return std::vector<long long>(first, last);
 }
 
 /**
- * @brief Gets oldest timestamps for specified component.
+ * @brief Removes specified timestamps from component's index.
+ *
+ * Both lists are sorted, so kept timestamps are compacted in place while walking them together.
+ * Every listed timestamp removes one entry, so records sharing a timestamp with a deleted one
+ * stay indexed. Deleting more timestamps than the journal takes at once is saved as a checkpoint
+ * instead.
  *
  * @param component
  *   Name of the hardware component
- * @param count
- *   Number of timestamps to return
- *
- * @return vector<long long>
- *   Vector of oldest timestamps, sorted in ascending order
+ * @param timestampsToDelete
+ *   Vector of timestamps to remove from index
  */
-std::vector<long long> IndexManager::getOldestTimestamps(const std::string& component,
-                                                         size_t count) const {
-  auto timestamps = getTimestamps(component);
-  if (timestamps.empty())
-    return {};
+void IndexManager::deleteTimestamps(const std::string& component,
+                                    const std::vector<long long>& timestampsToDelete) {
+  std::vector<long long> sorted(timestampsToDelete);
+  std::sort(sorted.begin(), sorted.end());
 
-  auto end = timestamps.size() > count ? timestamps.begin() + count : timestamps.end();
+  std::lock_guard<std::mutex> lock(mutex);
+  materialize(component);
+  if (index.count(component) == 0) {
+    return;
+  }
 
-  return std::vector<long long>(timestamps.begin(), end);
+  auto& timestamps = getWritable(component);
+  auto next = sorted.begin();
+  auto kept = timestamps.begin();
+  for (long long timestamp : timestamps) {
+    while (next != sorted.end() && *next < timestamp) {
+      ++next;
+    }
+    if (next != sorted.end() && *next == timestamp) {
+      ++next;
+    }
+    else {
+      *kept++ = timestamp;
+    }
+  }
+  timestamps.erase(kept, timestamps.end());
+
+  publishLocked();
+
+  if (journalEntries + sorted.size() >= JOURNAL_ENTRIES) {
+    saveLocked();
+    return;
+  }
+  for (long long timestamp : sorted) {
+    logChange('d', component, timestamp);
+  }
 }
 
 /**
- * @brief Removes specified timestamps from component's index.
+ * @brief Removes timestamps older than the given one from component's index.
  *
  * @param component
  *   Name of the hardware component
- * @param timestampsToDelete
- *   Vector of timestamps to remove from index
+ * @param timestamp
+ *   Oldest timestamp to keep
  */
-void IndexManager::deleteTimestamps(const std::string& component,
-                                    const std::vector<long long>& timestampsToDelete) {
-  auto it = index.find(component);
-  if (it != index.end()) {
-    auto& timestamps = it->second;
-    timestamps.erase(std::remove_if(timestamps.begin(), timestamps.end(),
-                                    [&](long long ts) {
-                                      return std::find(timestampsToDelete.begin(),
-                                                       timestampsToDelete.end(),
-                                                       ts) != timestampsToDelete.end();
-                                    }),
-                     timestamps.end());
-    saveIndex();
+void IndexManager::deleteOlderThan(const std::string& component, long long timestamp) {
+  deleteRange(component, LLONG_MIN, timestamp);
+}
+
+/**
+ * @brief Removes timestamps within the range [from, to) from component's index.
+ *
+ * The index is sorted, so the range is found by two binary searches and erased at once.
+ *
+ * @param component
+ *   Name of the hardware component
+ * @param from
+ *   First timestamp to remove
+ * @param to
+ *   Timestamp one past the removed range
+ */
+void IndexManager::deleteRange(const std::string& component, long long from, long long to) {
+  std::lock_guard<std::mutex> lock(mutex);
+  materialize(component);
+  if (index.count(component) > 0 && from < to) {
+    applyChange('r', component, from, to);
+    logChange('r', component, from, to);
+    publishLocked();
+  }
+}
+
+/**
+ * @brief Adds the given timestamps the index of a component lacks and saves to file if any was
+ * missing.
+ *
+ * Both lists are sorted, so the missing timestamps are found while walking them together and
+ * merged in one pass.
+ *
+ * @param component
+ *   Name of the hardware component
+ * @param timestamps
+ *   Timestamps of stored measurements of the component
+ */
+void IndexManager::mergeIndex(const std::string& component, std::vector<long long> timestamps) {
+  std::sort(timestamps.begin(), timestamps.end());
+
+  std::lock_guard<std::mutex> lock(mutex);
+  auto& indexed = getWritable(component);
+  std::vector<long long> missing;
+  auto next = indexed.begin();
+  for (long long timestamp : timestamps) {
+    while (next != indexed.end() && *next < timestamp) {
+      ++next;
+    }
+    if (next != indexed.end() && *next == timestamp) {
+      ++next;
+    }
+    else {
+      missing.push_back(timestamp);
+    }
+  }
+
+  if (missing.empty()) {
+    return;
   }
+
+  size_t middle = indexed.size();
+  indexed.insert(indexed.end(), missing.begin(), missing.end());
+  std::inplace_merge(indexed.begin(), indexed.begin() + middle, indexed.end());
+  publishLocked();
+  saveLocked();
 }
 
 /**
- * @brief Saves current index state to JSON file.
+ * @brief Saves current index state to the binary snapshot as a checkpoint and starts a new
+ * journal.
+ *
+ * The checkpoint is written durably before the journal is emptied; until then the old journal
+ * carries the previous generation and is ignored on load. A failed checkpoint is retried after
+ * another JOURNAL_ENTRIES changes.
  */
-void IndexManager::saveIndex() const {
-  nlohmann::json jsonIndex;
+void IndexManager::saveIndex() {
+  std::lock_guard<std::mutex> lock(mutex);
+  saveLocked();
+}
+
+/**
+ * @brief Writes the checkpoint and starts a new journal; the caller holds the mutex.
+ *
+ * Components still in the mapped snapshot are copied straight from the mapping, which stays valid
+ * after the new snapshot replaces the file. The JSON file of older versions is removed once the
+ * snapshot is written.
+ */
+void IndexManager::saveLocked() {
+  IndexFileHeader header;
+  memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+  header.components = index.size() + mapped.size();
+  header.generation = generation + 1;
+  std::string bytes(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  auto append = [&](const std::string& component, const char* timestamps, size_t count) {
+    IndexComponentHeader entry{static_cast<uint32_t>(component.size()), 0, count};
+    bytes.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    bytes.append(component);
+    bytes.append(alignTimestamps(component.size()) - component.size(), '\0');
+    bytes.append(timestamps, count * sizeof(int64_t));
+  };
   for (const auto& [component, timestamps] : index) {
-    jsonIndex[component] = timestamps;
+    append(component, reinterpret_cast<const char*>(timestamps->data()), timestamps->size());
+  }
+  for (const auto& [component, timestamps] : mapped) {
+    append(component, timestamps.first, timestamps.second);
   }
 
-  std::ofstream file(getIndexPath());
-  if (file) {
-    file << jsonIndex.dump(4);
+  journalEntries = 0;
+  try {
+    writeFileDurably(getSnapshotPath(), bytes);
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Warning: cannot save index: " << e.what() << "\n";
+    return;
   }
+  std::remove(getIndexPath().c_str());
+
+  ++generation;
+  startJournal();
 }
 
 /**
- * @brief Loads index from JSON file.
+ * @brief Empties the journal and writes its generation line; the caller holds the mutex.
+ */
+void IndexManager::startJournal() {
+  journalEntries = 0;
+  journal.close();
+  journal.open(getJournalPath(), std::ios::trunc);
+  journal << "generation " << generation << "\n";
+  journal.flush();
+}
+
+/**
+ * @brief Maps the binary snapshot, or loads the JSON file of older versions, and replays the
+ * journal on top of it.
+ *
+ * Only the snapshot headers are read, the timestamps are paged in when a component is first used.
+ * A torn last journal line is cut off and later changes are appended to the same journal, so
+ * startup takes no checkpoint unless the index is migrated from JSON.
  */
 void IndexManager::loadIndex() {
+  std::lock_guard<std::mutex> lock(mutex);
+  index.clear();
+  mapped.clear();
+  snapshotFile.reset();
+  generation = 0;
+
+  bool migrated = !mapSnapshot() && loadLegacyIndex();
+
+  std::ifstream file(getJournalPath());
+  std::string line;
+  bool current =
+      file && std::getline(file, line) && line == "generation " + std::to_string(generation);
+  std::streamoff valid = current ? static_cast<std::streamoff>(file.tellg()) : 0;
+  size_t replayed = 0;
+  if (current) {
+    while (std::getline(file, line) && !file.eof()) {
+      std::istringstream fields(line);
+      char operation;
+      long long timestamp;
+      long long end = 0;
+      std::string component;
+      if (!(fields >> operation >> timestamp) || (operation == 'r' && !(fields >> end)) ||
+          fields.get() != ' ' || !std::getline(fields, component)) {
+        break;
+      }
+      applyChange(operation, component, timestamp, end);
+      valid = file.tellg();
+      ++replayed;
+    }
+  }
+  file.close();
+
+  publishLocked();
+  if (!current && !migrated) {
+    startJournal();
+    return;
+  }
+  if (migrated || truncate(getJournalPath().c_str(), valid) != 0) {
+    saveLocked();
+    return;
+  }
+
+  journal.close();
+  journal.open(getJournalPath(), std::ios::app);
+  journalEntries = replayed;
+  if (journalEntries >= JOURNAL_ENTRIES) {
+    saveLocked();
+  }
+}
+
+/**
+ * @brief Maps the binary index snapshot; the caller holds the mutex.
+ *
+ * @return bool
+ *   False if the snapshot is missing or damaged
+ */
+bool IndexManager::mapSnapshot() {
+  std::string path = getSnapshotPath();
+  if (access(path.c_str(), F_OK) != 0) {
+    return false;
+  }
+
   try {
-    std::ifstream file(getIndexPath());
-    if (file) {
-      nlohmann::json jsonIndex;
-      file >> jsonIndex;
-      for (const auto& [component, timestamps] : jsonIndex.items()) {
-        index[component] = timestamps.get<std::vector<long long>>();
+    auto file = std::make_shared<MappedFile>(path);
+    IndexFileHeader header;
+    if (file->size() < sizeof(header)) {
+      return false;
+    }
+    memcpy(&header, file->data(), sizeof(header));
+    if (memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+      return false;
+    }
+
+    size_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.components; ++i) {
+      IndexComponentHeader entry;
+      if (file->size() - offset < sizeof(entry)) {
+        mapped.clear();
+        return false;
       }
+      memcpy(&entry, file->data() + offset, sizeof(entry));
+      offset += sizeof(entry);
+
+      size_t name = alignTimestamps(entry.nameLength);
+      if ((file->size() - offset) < name ||
+          (file->size() - offset - name) / sizeof(int64_t) < entry.count) {
+        mapped.clear();
+        return false;
+      }
+      std::string component(file->data() + offset, entry.nameLength);
+      offset += name;
+      mapped[component] = {file->data() + offset, entry.count};
+      offset += entry.count * sizeof(int64_t);
+    }
+
+    snapshotFile = file;
+    generation = header.generation;
+  }
+  catch (const std::exception&) {
+    mapped.clear();
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Loads the index from the JSON file of older versions; the caller holds the mutex.
+ *
+ * The oldest files hold the component map alone, later ones a generation and the map.
+ *
+ * @return bool
+ *   False if there is no such file
+ */
+bool IndexManager::loadLegacyIndex() {
+  std::ifstream file(getIndexPath());
+  if (!file) {
+    return false;
+  }
+
+  try {
+    nlohmann::json jsonIndex;
+    file >> jsonIndex;
+    if (jsonIndex.contains("index")) {
+      generation = jsonIndex.value("generation", uint64_t(0));
+      jsonIndex = jsonIndex["index"];
+    }
+    for (const auto& [component, timestamps] : jsonIndex.items()) {
+      auto sorted =
+          std::make_shared<std::vector<long long>>(timestamps.get<std::vector<long long>>());
+      std::sort(sorted->begin(), sorted->end());
+      index[component] = sorted;
     }
   }
   catch (...) {
     index.clear();
+    generation = 0;
   }
+
+  return true;
 }
 
 /**
- * @brief Gets path to index file.
+ * @brief Copies the timestamps of a component out of the mapped snapshot if they are still
+ * there; the caller holds the mutex.
+ *
+ * @param component
+ *   Name of the hardware component
+ */
+void IndexManager::materialize(const std::string& component) {
+  auto it = mapped.find(component);
+  if (it == mapped.end()) {
+    return;
+  }
+
+  auto timestamps = std::make_shared<std::vector<long long>>(it->second.second);
+  memcpy(timestamps->data(), it->second.first, it->second.second * sizeof(int64_t));
+  index[component] = timestamps;
+
+  mapped.erase(it);
+  if (mapped.empty()) {
+    snapshotFile.reset();
+  }
+}
+
+/**
+ * @brief Gets path to index file of older versions.
  *
  * @return string
  *   Full path to index.json file
  */
 std::string IndexManager::getIndexPath() const {
   return getDataDirectory() + "/" + INDEX_FILENAME;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Gets path to binary index snapshot.
+ *
+ * @return string
+ *   Full path to index.bin file
+ */
+std::string IndexManager::getSnapshotPath() const {
+  return getDataDirectory() + "/" + SNAPSHOT_FILENAME;
+}
+
+/**
+ * @brief Gets path to journal file.
+ *
+ * @return string
+ *   Full path to index.journal file
+ */
+std::string IndexManager::getJournalPath() const {
+  return getDataDirectory() + "/" + JOURNAL_FILENAME;
+}
+
+/**
+ * @brief Writes the buffered journal lines to the journal file.
+ */
+void IndexManager::flushJournal() {
+  std::lock_guard<std::mutex> lock(mutex);
+  journal.flush();
+}
+
+/**
+ * @brief Appends a change to the journal, taking a checkpoint once the journal is full.
+ *
+ * The line is buffered until the journal is flushed.
+ *
+ * @param operation
+ *   'a' for an added timestamp, 'd' for a deleted one, 'r' for a deleted range
+ * @param component
+ *   Name of the hardware component
+ * @param timestamp
+ *   Timestamp of the change, first timestamp of a range
+ * @param end
+ *   Timestamp one past a range, unused otherwise
+ */
+void IndexManager::logChange(char operation, const std::string& component, long long timestamp,
+                             long long end) {
+  journal << operation << ' ' << timestamp;
+  if (operation == 'r') {
+    journal << ' ' << end;
+  }
+  journal << ' ' << component << "\n";
+
+  if (++journalEntries >= JOURNAL_ENTRIES) {
+    saveLocked();
+  }
+}
+
+/**
+ * @brief Applies a change read from the journal to the index.
+ *
+ * @param operation
+ *   Operation passed to logChange()
+ * @param component
+ *   Name of the hardware component
+ * @param timestamp
+ *   Timestamp of the change, first timestamp of a range
+ * @param end
+ *   Timestamp one past a range, unused otherwise
+ */
+void IndexManager::applyChange(char operation, const std::string& component, long long timestamp,
+                               long long end) {
+  materialize(component);
+  auto it = index.find(component);
+  bool append = operation == 'a' && (it == index.end() || !it->second || it->second->empty() ||
+                                     it->second->back() <= timestamp);
+  auto& timestamps = getWritable(component, append);
+
+  if (operation == 'a') {
+    if (timestamps.empty() || timestamps.back() <= timestamp) {
+      timestamps.push_back(timestamp);
+    }
+    else {
+      timestamps.insert(std::upper_bound(timestamps.begin(), timestamps.end(), timestamp),
+                        timestamp);
+    }
+  }
+  else if (operation == 'd') {
+    auto found = std::lower_bound(timestamps.begin(), timestamps.end(), timestamp);
+    if (found != timestamps.end() && *found == timestamp) {
+      timestamps.erase(found);
+    }
+  }
+  else if (operation == 'r') {
+    timestamps.erase(std::lower_bound(timestamps.begin(), timestamps.end(), timestamp),
+                     std::lower_bound(timestamps.begin(), timestamps.end(), end));
+  }
+}
+
+/**
+ * @brief Gets the timestamps of a component for changing them, copying them first if a snapshot
+ * of them may be alive.
+ *
+ * Published views end at the size the timestamps had when they were published, so a timestamp is
+ * appended in place as long as the capacity allows. Any other change works on a copy unless the
+ * index alone holds the timestamps; copies reserve room for as many appends again.
+ *
+ * @param component
+ *   Name of the hardware component
+ * @param append
+ *   True if one timestamp is only appended, which leaves published views unchanged
+ *
+ * @return vector<long long>&
+ *   Timestamps safe to change
+ */
+std::vector<long long>& IndexManager::getWritable(const std::string& component, bool append) {
+  materialize(component);
+  auto& timestamps = index[component];
+  if (!timestamps) {
+    timestamps = std::make_shared<std::vector<long long>>();
+  }
+  else if (timestamps.use_count() == 1) {
+    // Orders the writes after the reads of the last released snapshot.
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+  else if (!append || timestamps->size() == timestamps->capacity()) {
+    auto copy = std::make_shared<std::vector<long long>>();
+    copy->reserve(timestamps->size() * 2);
+    copy->assign(timestamps->begin(), timestamps->end());
+    timestamps = copy;
+  }
+
+  return *timestamps;
+}
+
+/**
+ * @brief Publishes the current timestamps of every component to readers; the caller holds the
+ * mutex.
+ *
+ * Components still in the mapped snapshot are published as views into the mapping, which they
+ * keep alive.
+ */
+void IndexManager::publishLocked() {
+  auto components = std::make_shared<std::unordered_map<std::string, Snapshot>>();
+  for (const auto& [component, timestamps] : index) {
+    if (timestamps) {
+      (*components)[component] = {timestamps, timestamps->data(), timestamps->size()};
+    }
+  }
+  for (const auto& [component, timestamps] : mapped) {
+    (*components)[component] = {
+        snapshotFile, reinterpret_cast<const long long*>(timestamps.first), timestamps.second};
+  }
+
+  std::shared_ptr<const std::unordered_map<std::string, Snapshot>> next = std::move(components);
+  std::atomic_store(&published, next);
+}
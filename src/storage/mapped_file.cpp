@@ -0,0 +1,73 @@
+// Standard library headers
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Project headers
+#include "storage/mapped_file.h"
+
+/**
+ * @brief Maps a file into memory.
+ *
+ * @param path
+ *   Path to the file
+ *
+ * @throws std::runtime_error
+ *   If the file cannot be opened or mapped
+ */
+MappedFile::MappedFile(const std::string& path) : bytes(nullptr), length(0) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    throw std::runtime_error("Cannot open file: " + path);
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    throw std::runtime_error("Cannot stat file: " + path);
+  }
+
+  length = st.st_size;
+  if (length > 0) {
+    void* addr = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Cannot map file: " + path);
+    }
+    bytes = static_cast<const char*>(addr);
+  }
+
+  // The mapping keeps its own reference to the file.
+  close(fd);
+}
+
+/**
+ * @brief Unmaps the file.
+ */
+MappedFile::~MappedFile() {
+  if (bytes) {
+    munmap(const_cast<char*>(bytes), length);
+  }
+}
+
+/**
+ * @brief Gets pointer to the first byte of the file.
+ *
+ * @return const char*
+ *   Mapped bytes, nullptr for an empty file
+ */
+const char* MappedFile::data() const {
+  return bytes;
+}
+
+/**
+ * @brief Gets size of the mapped file.
+ *
+ * @return size_t
+ *   Size in bytes
+ */
+size_t MappedFile::size() const {
+  return length;
+}
@@ -1,5 +1,8 @@
 // Standard library headers
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <sys/select.h>
 #include <thread>
@@ -9,6 +12,8 @@
 #include "api/ohm_api.h"
 #include "api/ohm_data.h"
 #include "config/config.h"
+#include "config/config_loader.h"
+#include "inputs/ohm_collector.h"
 #include "inputs/ohm_source.h"
 #include "storage/measurement_handler.h"
 
@@ -50,11 +55,35 @@ void MeasurementHandler::clearInputBuffer() {
   cin.ignore(numeric_limits<streamsize>::max(), '\n');
 }
 
+/**
+ * @brief Gets the components a menu choice stands for.
+ *
+ * @param component
+ *   Component name, or "All components".
+ *
+ * @return
+ *   The GPU, CPU and motherboard for "All components", otherwise the component alone.
+ */
+static std::vector<std::string> expandComponent(const std::string& component) {
+  if (component == "All components") {
+    return {"GPU", "CPU", "Motherboard"};
+  }
+
+  return {component};
+}
+
 /**
  * @brief Constructs a MeasurementHandler and initializes the data source.
+ *
+ * Polls the configured OHM hosts concurrently if there are any, otherwise OHM_URL alone.
  */
 MeasurementHandler::MeasurementHandler() {
-  source = std::make_unique<OHMSource>();
+  if (ConfigLoader::OHM_HOSTS.empty()) {
+    source = std::make_unique<OHMSource>();
+  }
+  else {
+    source = std::make_unique<OHMCollector>(ConfigLoader::OHM_HOSTS, ConfigLoader::OHM_TIMEOUT_MS);
+  }
 }
 
 /**
@@ -109,107 +138,156 @@ int MeasurementHandler::askForDuration() {
  * @brief Asks the user for the measurement interval.
  *
  * @return
- *   Interval in seconds.
+ *   Interval in milliseconds.
  */
 int MeasurementHandler::askForInterval() {
   std::string input;
   while (true) {
-    std::cout << "Enter measurement interval in seconds (1 or more): ";
+    std::cout << "Enter measurement interval in seconds (e.g. 0.1, 0.5, 1): ";
     if (!(std::cin >> input)) {
       clearInputBuffer();
       continue;
     }
 
-    if (input.find_first_not_of("0123456789") != std::string::npos) {
-      std::cout << "Invalid interval. Please enter a whole number.\n";
+    if (input.find_first_not_of("0123456789.") != std::string::npos ||
+        std::count(input.begin(), input.end(), '.') > 1 || input == ".") {
+      std::cout << "Invalid interval. Please enter a number such as 0.1 or 2.\n";
+      continue;
+    }
+
+    double seconds;
+    try {
+      seconds = std::stod(input);
+    }
+    catch (const std::exception&) {
+      std::cout << "Invalid interval. Please enter a number such as 0.1 or 2.\n";
       continue;
     }
 
-    int interval = std::stoi(input);
-    if (interval < 1) {
-      std::cout << "Invalid interval. Please enter a number greater than 0.\n";
+    if (seconds * 1000.0 < MIN_INTERVAL_MS || seconds * 1000.0 > MAX_INTERVAL_MS) {
+      std::cout << "Invalid interval. Please enter a number between " << MIN_INTERVAL_MS / 1000.0
+                << " and " << MAX_INTERVAL_MS / 1000 << ".\n";
       continue;
     }
 
-    return interval;
+    return static_cast<int>(std::llround(seconds * 1000.0));
   }
 }
 
 /**
  * @brief Executes the monitoring process for a given component.
  *
+ * Samples are scheduled against fixed deadlines on the steady clock (start, start + interval,
+ * start + 2 * interval, ...), so the time spent fetching and saving does not accumulate as drift.
+ * A sample that finishes after one or more later deadlines have passed skips those ticks instead
+ * of firing them in a burst, and reports them as missed.
+ *
+ * When the samples come from the local OHM endpoint, the timing of each request is added up and
+ * reported with the missed ticks and in the summary, so slow fetches and reconnects show up as
+ * the cause of missed ticks. The collector polling remote hosts makes no such requests, so the
+ * report is left out for it.
+ *
+ * Intervals below a second store several samples under the same whole-second timestamp. They are
+ * saved one after another from this thread, so their sequence in the storage engine follows the
+ * order they were taken in, which lists, exports and deletes rely on.
+ *
  * @param component
  *   Name of the component to monitor.
  * @param duration
  *   Total monitoring time in seconds.
  * @param interval
- *   Time between measurements in seconds.
+ *   Time between measurements in milliseconds.
  */
 void MeasurementHandler::performMonitoring(const std::string& component, int duration,
                                            int interval) {
-  bool monitoring = true;
-  int elapsedSeconds = 0;
+  using Clock = std::chrono::steady_clock;
+
+  const auto period = std::chrono::milliseconds(interval);
+  const auto start = Clock::now();
+  const auto end = start + std::chrono::seconds(duration);
+  auto deadline = start;
+  uint64_t samples = 0;
+  uint64_t missed = 0;
+  uint64_t fetches = 0;
+  uint64_t connects = 0;
+  int64_t fetchTotal = 0;
+  int64_t fetchMax = 0;
+  int64_t firstByteTotal = 0;
+  const bool timed = dynamic_cast<OHMSource*>(source.get()) != nullptr;
 
-  std::cout << "Starting monitoring for " << component << " every " << interval << " seconds...\n";
+  std::cout << "Starting monitoring for " << component << " every " << interval << " ms...\n";
 
-  while (monitoring) {
+  while (true) {
     try {
-      if (component == "All components") {
-        recordAllMeasurements();
-      }
-      else {
-        recordMeasurement(component);
-      }
+      recordMeasurements(expandComponent(component));
     }
     catch (...) {
       std::cerr << "Error fetching or saving data.\n";
     }
+    ++samples;
+
+    FetchTiming timing = timed ? OHMFetcher::getInstance().getLastTiming() : FetchTiming{};
+    if (timing.total > 0) {
+      ++fetches;
+      connects += timing.connect > 0 ? 1 : 0;
+      fetchTotal += timing.total;
+      fetchMax = std::max(fetchMax, timing.total);
+      firstByteTotal += timing.firstByte;
+    }
 
-    if (duration > 0) {
-      elapsedSeconds += interval;
-      if (elapsedSeconds >= duration) {
-        monitoring = false;
+    deadline += period;
+    uint64_t skipped = 0;
+    for (auto now = Clock::now(); now >= deadline && (duration == 0 || deadline < end);
+         deadline += period) {
+      ++skipped;
+    }
+    if (skipped > 0) {
+      missed += skipped;
+      std::cerr << "Missed " << skipped << " tick(s): the sample took longer than the interval";
+      if (timing.total > 0) {
+        std::cerr << " (fetch " << timing.total / 1000.0 << " ms, first byte "
+                  << timing.firstByte / 1000.0 << " ms)";
       }
+      std::cerr << ".\n";
     }
 
-    if (monitoring) {
-      std::this_thread::sleep_for(std::chrono::seconds(interval));
+    if (duration > 0 && deadline >= end) {
+      break;
     }
 
+    std::this_thread::sleep_until(deadline);
+
     if (duration == 0 && kbhit()) {
-      monitoring = false;
+      break;
     }
   }
 
-  std::cout << "Monitoring completed.\n";
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start);
+  std::cout << "Monitoring completed: " << samples << " sample(s) in " << elapsed.count() / 1000.0
+            << " s, " << missed << " missed tick(s).\n";
+  if (fetches > 0) {
+    std::cout << "OHM fetches: " << fetches << ", avg " << fetchTotal / 1000.0 / fetches
+              << " ms (first byte " << firstByteTotal / 1000.0 / fetches << " ms), max "
+              << fetchMax / 1000.0 << " ms, " << connects << " new connection(s).\n";
+  }
 }
 
 /**
- * @brief Records a single temperature measurement for a component.
+ * @brief Records temperature measurements of components from one snapshot of the source.
  *
- * @param component
- *   Name of the component to measure.
- */
-void MeasurementHandler::recordMeasurement(const std::string& component) {
-  Measurement m = source->getMeasurement(component);
-  storage.saveRecord(m);
-  std::cout << "Recorded " << component << " temperature: " << m.temperature << "°C\n";
-}
-
-/**
- * @brief Records temperature measurements for all components (GPU, CPU, Motherboard).
+ * All readings of a machine come from the same document and share its timestamp.
+ *
+ * @param components
+ *   Names of the components to measure.
  */
-void MeasurementHandler::recordAllMeasurements() {
-  std::vector<std::string> components = {"GPU", "CPU", "Motherboard"};
-  for (const auto& comp : components) {
-    try {
-      Measurement m = source->getMeasurement(comp);
-      storage.saveRecord(m);
-      std::cout << "Recorded " << comp << " temperature: " << m.temperature << "°C\n";
-    }
-    catch (const std::exception& e) {
-      std::cerr << "Skipping " << comp << ": " << e.what() << "\n";
-    }
+void MeasurementHandler::recordMeasurements(const std::vector<std::string>& components) {
+  std::vector<std::string> errors;
+  for (const auto& m : source->getSnapshot(components, errors)) {
+    storage.saveRecord(m);
+    std::cout << "Recorded " << m.component << " temperature: " << m.temperature << "°C\n";
+  }
+  for (const auto& error : errors) {
+    std::cerr << "Skipping " << error << "\n";
   }
 }
 
@@ -220,27 +298,10 @@ void MeasurementHandler::recordAllMeasurements() {
  *   Name of the hardware component to record.
  */
 void MeasurementHandler::addSingleRecord(const std::string& componentName) {
-  if (componentName == "All components") {
-    std::vector<std::string> comps = {"GPU", "CPU", "Motherboard"};
-    for (const auto& comp : comps) {
-      try {
-        Measurement m = source->getMeasurement(comp);
-        storage.saveRecord(m);
-        std::cout << "Recorded " << comp << " temperature: " << m.temperature << "°C\n";
-      }
-      catch (const std::exception& e) {
-        std::cerr << "Skipping " << comp << ": " << e.what() << "\n";
-      }
-    }
+  try {
+    recordMeasurements(expandComponent(componentName));
   }
-  else {
-    try {
-      Measurement m = source->getMeasurement(componentName);
-      storage.saveRecord(m);
-      std::cout << "Recorded " << componentName << " temperature: " << m.temperature << "°C\n";
-    }
-    catch (const std::exception& e) {
-      std::cerr << "Error: " << e.what() << "\n";
-    }
+  catch (const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
   }
 }
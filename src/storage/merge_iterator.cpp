@@ -0,0 +1,82 @@
+// Standard library headers
+#include <utility>
+
+// Project headers
+#include "storage/merge_iterator.h"
+
+/**
+ * @brief Creates an iterator over the given series.
+ *
+ * @param series
+ *   Series to merge, each ordered by timestamp
+ */
+MergeIterator::MergeIterator(std::vector<std::vector<Measurement>> series)
+    : series(std::move(series)) {
+  for (size_t i = 0; i < this->series.size(); ++i) {
+    if (!this->series[i].empty()) {
+      heap.push({this->series[i].front().timestamp, i, 0});
+    }
+  }
+}
+
+/**
+ * @brief Gets the next record of the merged series.
+ *
+ * @param out
+ *   Receives the record
+ *
+ * @return bool
+ *   False when all series are exhausted
+ */
+bool MergeIterator::next(Measurement& out) {
+  size_t index;
+
+  return next(out, index);
+}
+
+/**
+ * @brief Gets the next record of the merged series and the series it comes from.
+ *
+ * @param out
+ *   Receives the record
+ * @param index
+ *   Receives the index of the series holding the record
+ *
+ * @return bool
+ *   False when all series are exhausted
+ */
+bool MergeIterator::next(Measurement& out, size_t& index) {
+  if (heap.empty()) {
+    return false;
+  }
+
+  Cursor cursor = heap.top();
+  heap.pop();
+
+  const auto& records = series[cursor.series];
+  out = records[cursor.position];
+  index = cursor.series;
+  if (++cursor.position < records.size()) {
+    cursor.timestamp = records[cursor.position].timestamp;
+    heap.push(cursor);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Orders cursors so that the heap top holds the oldest record.
+ *
+ * @param other
+ *   Cursor to compare with
+ *
+ * @return bool
+ *   True if this cursor comes after the other one
+ */
+bool MergeIterator::Cursor::operator>(const Cursor& other) const {
+  if (timestamp != other.timestamp) {
+    return timestamp > other.timestamp;
+  }
+
+  return series > other.series;
+}
@@ -0,0 +1,295 @@
+// Standard library headers
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// Project headers
+#include "storage/rollup_store.h"
+#include "storage/segment_log.h"
+#include "utils/utils.h"
+
+/**
+ * @brief Header of a rollup file.
+ */
+struct RollupFileHeader {
+  char magic[4];
+  uint32_t reserved;
+  uint64_t lsn;
+};
+
+static constexpr char ROLLUP_MAGIC[4] = {'H', 'R', 'U', 'P'};
+
+/**
+ * @brief Adds a measurement to a bucket of a tier, creating the bucket if needed.
+ *
+ * @param tier
+ *   Buckets of the series by start
+ * @param start
+ *   Start of the bucket holding the measurement
+ * @param temperature
+ *   Temperature of the measurement
+ */
+static void addTo(std::map<int64_t, Rollup>& tier, int64_t start, double temperature) {
+  auto [it, inserted] = tier.try_emplace(start, Rollup{start, temperature, temperature, 0.0, 0});
+  Rollup& bucket = it->second;
+  bucket.min = std::min(bucket.min, temperature);
+  bucket.max = std::max(bucket.max, temperature);
+  bucket.sum += temperature;
+  ++bucket.count;
+}
+
+/**
+ * @brief Appends the buckets of a tier to a file image, preceded by their number.
+ *
+ * @param out
+ *   File image
+ * @param tier
+ *   Buckets ordered by start
+ */
+static void writeTier(std::string& out, const std::map<int64_t, Rollup>& tier) {
+  uint64_t count = tier.size();
+  out.append(reinterpret_cast<const char*>(&count), sizeof(count));
+  for (const auto& [start, bucket] : tier) {
+    out.append(reinterpret_cast<const char*>(&bucket), sizeof(bucket));
+  }
+}
+
+/**
+ * @brief Reads the buckets of a tier written by writeTier() from a file image.
+ *
+ * @param bytes
+ *   File image
+ * @param offset
+ *   Offset of the tier, advanced past it
+ * @param tier
+ *   Receives the buckets
+ *
+ * @return bool
+ *   False if the image ends within the tier
+ */
+static bool readTier(const std::string& bytes, size_t& offset, std::map<int64_t, Rollup>& tier) {
+  uint64_t count;
+  if (bytes.size() - offset < sizeof(count)) {
+    return false;
+  }
+  memcpy(&count, bytes.data() + offset, sizeof(count));
+  offset += sizeof(count);
+
+  if ((bytes.size() - offset) / sizeof(Rollup) < count) {
+    return false;
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    Rollup bucket;
+    memcpy(&bucket, bytes.data() + offset, sizeof(bucket));
+    tier.emplace_hint(tier.end(), bucket.start, bucket);
+    offset += sizeof(bucket);
+  }
+
+  return true;
+}
+
+/**
+ * @brief Adds a measurement to the minute and hour buckets holding it.
+ *
+ * @param record
+ *   Measurement to add
+ */
+void RollupStore::add(const Measurement& record) {
+  addTo(minutes[record.component], align(record.timestamp, MINUTE), record.temperature);
+  addTo(hours[record.component], align(record.timestamp, HOUR), record.temperature);
+  dirty.insert(record.component);
+}
+
+/**
+ * @brief Removes minute and hour buckets starting within the range [begin, end).
+ *
+ * @param series
+ *   Name of the component
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ */
+void RollupStore::erase(const std::string& series, int64_t begin, int64_t end) {
+  for (auto* tiers : {&minutes, &hours}) {
+    auto it = tiers->find(series);
+    if (it != tiers->end() && begin < end) {
+      it->second.erase(it->second.lower_bound(begin), it->second.lower_bound(end));
+    }
+  }
+  dirty.insert(series);
+}
+
+/**
+ * @brief Removes buckets of one tier that end before a timestamp.
+ *
+ * @param series
+ *   Name of the component
+ * @param width
+ *   MINUTE or HOUR
+ * @param timestamp
+ *   Oldest timestamp to keep
+ */
+void RollupStore::expire(const std::string& series, int64_t width, int64_t timestamp) {
+  auto& tiers = width == HOUR ? hours : minutes;
+  auto it = tiers.find(series);
+  if (it == tiers.end()) {
+    return;
+  }
+
+  auto& buckets = it->second;
+  auto last = buckets.lower_bound(timestamp - width + 1);
+  if (last != buckets.begin()) {
+    buckets.erase(buckets.begin(), last);
+    dirty.insert(series);
+  }
+}
+
+/**
+ * @brief Gets buckets of a tier starting within the range [begin, end).
+ *
+ * @param series
+ *   Name of the component
+ * @param width
+ *   MINUTE or HOUR
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ *
+ * @return std::vector<Rollup>
+ *   Buckets ordered by start
+ */
+std::vector<Rollup> RollupStore::read(const std::string& series, int64_t width, int64_t begin,
+                                      int64_t end) const {
+  const auto& tiers = width == HOUR ? hours : minutes;
+  std::vector<Rollup> result;
+
+  auto it = tiers.find(series);
+  if (it != tiers.end() && begin < end) {
+    for (auto bucket = it->second.lower_bound(begin); bucket != it->second.lower_bound(end);
+         ++bucket) {
+      result.push_back(bucket->second);
+    }
+  }
+
+  return result;
+}
+
+/**
+ * @brief Loads the rollups of a series from its file.
+ *
+ * @param series
+ *   Name of the component
+ * @param lsn
+ *   Receives the newest log sequence number folded into the file
+ *
+ * @return bool
+ *   False if the file is missing or damaged; the series then has no buckets
+ */
+bool RollupStore::load(const std::string& series, uint64_t& lsn) {
+  minutes.erase(series);
+  hours.erase(series);
+
+  std::ifstream file(getPath(series), std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  RollupFileHeader header;
+  if (bytes.size() < sizeof(header)) {
+    return false;
+  }
+  memcpy(&header, bytes.data(), sizeof(header));
+  if (memcmp(header.magic, ROLLUP_MAGIC, sizeof(ROLLUP_MAGIC)) != 0) {
+    return false;
+  }
+
+  size_t offset = sizeof(header);
+  if (!readTier(bytes, offset, minutes[series]) || !readTier(bytes, offset, hours[series])) {
+    minutes.erase(series);
+    hours.erase(series);
+
+    return false;
+  }
+  lsn = header.lsn;
+
+  return true;
+}
+
+/**
+ * @brief Durably writes the rollups of every series changed since the last save.
+ *
+ * @param lsn
+ *   Newest log sequence number folded into the rollups
+ *
+ * @throws std::runtime_error
+ *   If a file cannot be written
+ */
+void RollupStore::save(uint64_t lsn) {
+  for (const auto& series : dirty) {
+    RollupFileHeader header;
+    memcpy(header.magic, ROLLUP_MAGIC, sizeof(ROLLUP_MAGIC));
+    header.reserved = 0;
+    header.lsn = lsn;
+
+    std::string bytes(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeTier(bytes, minutes[series]);
+    writeTier(bytes, hours[series]);
+    writeFileDurably(getPath(series), bytes);
+  }
+  dirty.clear();
+}
+
+/**
+ * @brief Folds a bucket into another one.
+ *
+ * @param into
+ *   Bucket receiving the measurements
+ * @param from
+ *   Bucket to add
+ */
+void RollupStore::combine(Rollup& into, const Rollup& from) {
+  if (into.count == 0) {
+    into.min = from.min;
+    into.max = from.max;
+  }
+  else if (from.count > 0) {
+    into.min = std::min(into.min, from.min);
+    into.max = std::max(into.max, from.max);
+  }
+  into.sum += from.sum;
+  into.count += from.count;
+}
+
+/**
+ * @brief Gets the start of the bucket of a given width holding a timestamp.
+ *
+ * @param timestamp
+ *   Timestamp of a record
+ * @param width
+ *   Width of the bucket
+ *
+ * @return int64_t
+ *   First timestamp of the bucket
+ */
+int64_t RollupStore::align(int64_t timestamp, int64_t width) {
+  int64_t start = timestamp - timestamp % width;
+
+  return timestamp % width < 0 ? start - width : start;
+}
+
+/**
+ * @brief Gets path to the rollup file of a series.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return std::string
+ *   Full path to the file
+ */
+std::string RollupStore::getPath(const std::string& series) const {
+  return SegmentLog::getInstance().getSegmentDirectory() + "/" + series + ROLLUP_EXTENSION;
+}
@@ -0,0 +1,420 @@
+// Standard library headers
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
+// Project headers
+#include "storage/segment_log.h"
+#include "utils/utils.h"
+
+/**
+ * @brief Gets the singleton instance of SegmentLog.
+ *
+ * @return SegmentLog&
+ *   Reference to the singleton instance of SegmentLog
+ */
+SegmentLog& SegmentLog::getInstance() {
+  static SegmentLog instance;
+
+  return instance;
+}
+
+/**
+ * @brief Constructor loads the component registry from file.
+ *
+ * Older versions also wrote every record to an ALL_SERIES segment; it only duplicates the
+ * component segments and is removed.
+ */
+SegmentLog::SegmentLog() {
+  loadRegistry();
+  std::remove(getSegmentPath(ALL_SERIES).c_str());
+}
+
+/**
+ * @brief Checks whether a segment file exists for the series.
+ *
+ * @param series
+ *   Name of the series
+ *
+ * @return bool
+ *   True if the segment file exists
+ */
+bool SegmentLog::exists(const std::string& series) const {
+  return access(getSegmentPath(series).c_str(), F_OK) == 0;
+}
+
+/**
+ * @brief Gets number of complete records stored in the series segment.
+ *
+ * @param series
+ *   Name of the series
+ *
+ * @return size_t
+ *   Number of records, 0 if the segment does not exist
+ */
+size_t SegmentLog::count(const std::string& series) const {
+  struct stat st;
+  if (stat(getSegmentPath(series).c_str(), &st) != 0 ||
+      st.st_size < (off_t)sizeof(SegmentHeader)) {
+    return 0;
+  }
+
+  return (st.st_size - sizeof(SegmentHeader)) / sizeof(SegmentRecord);
+}
+
+/**
+ * @brief Maps the series segment and returns a view over records in the range [begin, end).
+ *
+ * @param series
+ *   Name of the series
+ * @param begin
+ *   Position of the first record of the view
+ * @param end
+ *   Position one past the last record of the view
+ *
+ * @return SegmentView
+ *   View over the records, clamped to the size of the segment
+ *
+ * @throws std::runtime_error
+ *   If the segment cannot be mapped or is not a valid segment file
+ */
+SegmentView SegmentLog::view(const std::string& series, size_t begin, size_t end) const {
+  std::string path = getSegmentPath(series);
+  auto file = std::make_shared<const MappedFile>(path);
+
+  SegmentHeader header;
+  if (file->size() < sizeof(header)) {
+    throw std::runtime_error("Invalid segment file: " + path);
+  }
+
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (std::memcmp(header.magic, "HSEG", 4) != 0 || header.recordSize != sizeof(SegmentRecord)) {
+    throw std::runtime_error("Invalid segment file: " + path);
+  }
+
+  // A torn record at the tail is not part of the segment.
+  end = std::min(end, (file->size() - sizeof(SegmentHeader)) / sizeof(SegmentRecord));
+  if (begin >= end) {
+    return SegmentView();
+  }
+
+  auto records = reinterpret_cast<const SegmentRecord*>(file->data() + sizeof(SegmentHeader));
+
+  return SegmentView(std::move(file), records + begin, end - begin);
+}
+
+/**
+ * @brief Reads records in the range [begin, end) from the series segment.
+ *
+ * @param series
+ *   Name of the series
+ * @param begin
+ *   Position of the first record to read
+ * @param end
+ *   Position one past the last record to read
+ *
+ * @return std::vector<Measurement>
+ *   Records in the order they were appended
+ *
+ * @throws std::runtime_error
+ *   If the segment cannot be opened or is not a valid segment file
+ */
+std::vector<Measurement> SegmentLog::read(const std::string& series, size_t begin,
+                                          size_t end) const {
+  SegmentView records = view(series, begin, end);
+
+  std::vector<Measurement> result;
+  result.reserve(records.size());
+  for (const auto& rec : records) {
+    result.push_back({getComponentName(rec.componentId), rec.temperature, rec.timestamp});
+  }
+
+  return result;
+}
+
+/**
+ * @brief Atomically and durably replaces the content of the series segment.
+ *
+ * @param series
+ *   Name of the series
+ * @param records
+ *   Records that make up the new segment
+ *
+ * @throws std::runtime_error
+ *   If the segment cannot be written
+ */
+void SegmentLog::rewrite(const std::string& series, const std::vector<Measurement>& records) {
+  ensureDataDirectoryExists(getDataDirectory());
+  ensureDataDirectoryExists(getSegmentDirectory());
+
+  SegmentHeader header{{'H', 'S', 'E', 'G'}, SEGMENT_VERSION, sizeof(SegmentRecord), 0};
+  std::string bytes(reinterpret_cast<const char*>(&header), sizeof(header));
+  bytes.reserve(sizeof(header) + records.size() * sizeof(SegmentRecord));
+  for (const auto& record : records) {
+    SegmentRecord rec = toSegmentRecord(record);
+    bytes.append(reinterpret_cast<const char*>(&rec), sizeof(rec));
+  }
+
+  writeFileDurably(getSegmentPath(series), bytes);
+}
+
+/**
+ * @brief Drops records past the given position from the series segment.
+ *
+ * @param series
+ *   Name of the series
+ * @param count
+ *   Number of records to keep
+ *
+ * @throws std::runtime_error
+ *   If the segment cannot be truncated
+ */
+void SegmentLog::truncate(const std::string& series, size_t count) {
+  std::string path = getSegmentPath(series);
+  off_t size = sizeof(SegmentHeader) + count * sizeof(SegmentRecord);
+
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0 || st.st_size <= size) {
+    return;
+  }
+
+  if (::truncate(path.c_str(), size) != 0) {
+    throw std::runtime_error("Cannot truncate segment file: " + path);
+  }
+}
+
+/**
+ * @brief Removes the series segment.
+ *
+ * @param series
+ *   Name of the series
+ *
+ * @throws std::runtime_error
+ *   If the segment exists and cannot be removed
+ */
+void SegmentLog::remove(const std::string& series) {
+  std::string path = getSegmentPath(series);
+  if (std::remove(path.c_str()) != 0 && exists(series)) {
+    throw std::runtime_error("Cannot remove segment file: " + path);
+  }
+}
+
+/**
+ * @brief Gets names of all registered components.
+ *
+ * Older versions registered ALL_SERIES as well; it is not a component and is skipped.
+ *
+ * @return std::vector<std::string>
+ *   Component names in the order they were registered, without ALL_SERIES
+ */
+std::vector<std::string> SegmentLog::getSeries() const {
+  std::lock_guard<std::mutex> lock(registryMutex);
+
+  std::vector<std::string> series;
+  for (const auto& name : componentNames) {
+    if (name != ALL_SERIES) {
+      series.push_back(name);
+    }
+  }
+
+  return series;
+}
+
+/**
+ * @brief Gets identifier of a component, registering it if needed.
+ *
+ * @param component
+ *   Name of the hardware component
+ *
+ * @return uint32_t
+ *   Identifier stored in segment records
+ */
+uint32_t SegmentLog::getComponentId(const std::string& component) {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  auto it = componentIds.find(component);
+  if (it != componentIds.end()) {
+    return it->second;
+  }
+
+  uint32_t id = componentNames.size();
+  componentIds[component] = id;
+  componentNames.push_back(component);
+  saveRegistry();
+
+  return id;
+}
+
+/**
+ * @brief Gets component name for an identifier.
+ *
+ * @param id
+ *   Identifier stored in segment records
+ *
+ * @return std::string
+ *   Name of the hardware component
+ *
+ * @throws std::runtime_error
+ *   If the identifier is not registered
+ */
+std::string SegmentLog::getComponentName(uint32_t id) const {
+  std::lock_guard<std::mutex> lock(registryMutex);
+  if (id >= componentNames.size()) {
+    throw std::runtime_error("Unknown component id: " + std::to_string(id));
+  }
+
+  return componentNames[id];
+}
+
+/**
+ * @brief Gets path to the segment file of a series.
+ *
+ * @param series
+ *   Name of the series
+ *
+ * @return std::string
+ *   Full path to the segment file
+ */
+std::string SegmentLog::getSegmentPath(const std::string& series) const {
+  return getSegmentDirectory() + "/" + series + SEGMENT_EXTENSION;
+}
+
+/**
+ * @brief Gets path to the directory holding segment files.
+ *
+ * @return std::string
+ *   Full path to the segments directory
+ */
+std::string SegmentLog::getSegmentDirectory() const {
+  return getDataDirectory() + "/" + SEGMENT_DIRNAME;
+}
+
+/**
+ * @brief Converts a measurement into its binary form.
+ *
+ * @param record
+ *   Measurement to convert
+ *
+ * @return SegmentRecord
+ *   Binary record
+ */
+SegmentRecord SegmentLog::toSegmentRecord(const Measurement& record) {
+  return SegmentRecord{getComponentId(record.component), 0, record.temperature, record.timestamp};
+}
+
+/**
+ * @brief Loads component registry from JSON file.
+ */
+void SegmentLog::loadRegistry() {
+  try {
+    std::ifstream file(getSegmentDirectory() + "/" + REGISTRY_FILENAME);
+    if (file) {
+      nlohmann::json registry;
+      file >> registry;
+      componentNames = registry.get<std::vector<std::string>>();
+      for (uint32_t id = 0; id < componentNames.size(); ++id) {
+        componentIds[componentNames[id]] = id;
+      }
+    }
+  }
+  catch (...) {
+    componentIds.clear();
+    componentNames.clear();
+  }
+}
+
+/**
+ * @brief Saves component registry to JSON file.
+ *
+ * @throws std::runtime_error
+ *   If the registry cannot be written
+ */
+void SegmentLog::saveRegistry() const {
+  ensureDataDirectoryExists(getDataDirectory());
+  ensureDataDirectoryExists(getSegmentDirectory());
+
+  // Run files refer to components by identifier, so the registry must not be lost.
+  writeFileDurably(getSegmentDirectory() + "/" + REGISTRY_FILENAME,
+                   nlohmann::json(componentNames).dump(4));
+}
+
+/**
+ * @brief Creates an empty view.
+ */
+SegmentView::SegmentView() : first(nullptr), count(0) {
+}
+
+/**
+ * @brief Creates a view over records of a mapped segment.
+ *
+ * @param file
+ *   Mapping that holds the records
+ * @param first
+ *   Pointer to the first record of the view
+ * @param count
+ *   Number of records in the view
+ */
+SegmentView::SegmentView(std::shared_ptr<const MappedFile> file, const SegmentRecord* first,
+                         size_t count)
+    : file(std::move(file)), first(first), count(count) {
+}
+
+/**
+ * @brief Gets pointer to the first record.
+ *
+ * @return const SegmentRecord*
+ *   First record of the view
+ */
+const SegmentRecord* SegmentView::begin() const {
+  return first;
+}
+
+/**
+ * @brief Gets pointer one past the last record.
+ *
+ * @return const SegmentRecord*
+ *   End of the view
+ */
+const SegmentRecord* SegmentView::end() const {
+  return first + count;
+}
+
+/**
+ * @brief Gets number of records in the view.
+ *
+ * @return size_t
+ *   Number of records
+ */
+size_t SegmentView::size() const {
+  return count;
+}
+
+/**
+ * @brief Checks whether the view holds no records.
+ *
+ * @return bool
+ *   True if the view is empty
+ */
+bool SegmentView::empty() const {
+  return count == 0;
+}
+
+/**
+ * @brief Gets a record of the view.
+ *
+ * @param index
+ *   Position of the record within the view
+ *
+ * @return const SegmentRecord&
+ *   Record at the position
+ */
+const SegmentRecord& SegmentView::operator[](size_t index) const {
+  return first[index];
+}
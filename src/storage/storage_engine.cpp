@@ -0,0 +1,1997 @@
+// Standard library headers
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <ctime>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+// Project headers
+#include "config/config_loader.h"
+#include "storage/chunk_store.h"
+#include "storage/index_manager.h"
+#include "storage/merge_iterator.h"
+#include "storage/segment_log.h"
+#include "storage/storage_engine.h"
+#include "storage/write_ahead_log.h"
+#include "utils/utils.h"
+
+/**
+ * @brief Number of digits of the sequence number in run names, so that names sort by it.
+ */
+static constexpr size_t LSN_DIGITS = 20;
+
+/**
+ * @brief Gets the range of positions of a part that can hold the oldest or newest records.
+ *
+ * @param total
+ *   Number of records in the part
+ * @param count
+ *   Number of records needed, 0 or less for all records
+ * @param fromStart
+ *   True for the oldest records, false for the newest ones
+ *
+ * @return std::pair<size_t, size_t>
+ *   Range [begin, end) of positions
+ */
+static std::pair<size_t, size_t> selectRange(size_t total, int count, bool fromStart) {
+  size_t needed = count > 0 ? std::min(total, static_cast<size_t>(count)) : total;
+
+  return fromStart ? std::make_pair(size_t(0), needed) : std::make_pair(total - needed, total);
+}
+
+/**
+ * @brief Gets the range of positions of a sorted run holding timestamps in [begin, end).
+ *
+ * @param records
+ *   Records of the run, ordered by timestamp
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ *
+ * @return std::pair<size_t, size_t>
+ *   Range [first, last) of positions
+ */
+static std::pair<size_t, size_t> findTimestamps(const SegmentView& records, long long begin,
+                                                long long end) {
+  auto before = [](const SegmentRecord& record, long long timestamp) {
+    return record.timestamp < timestamp;
+  };
+  auto first = std::lower_bound(records.begin(), records.end(), begin, before);
+  auto last = std::lower_bound(first, records.end(), end, before);
+
+  return {static_cast<size_t>(first - records.begin()),
+          static_cast<size_t>(last - records.begin())};
+}
+
+/**
+ * @brief Gets the singleton instance of StorageEngine.
+ *
+ * @return StorageEngine&
+ *   Reference to the singleton instance of StorageEngine
+ *
+ * @throws std::runtime_error
+ *   If the storage cannot be recovered
+ */
+StorageEngine& StorageEngine::getInstance() {
+  static StorageEngine instance;
+
+  return instance;
+}
+
+/**
+ * @brief Constructor recovers the storage and starts the background thread.
+ *
+ * @throws std::runtime_error
+ *   If the storage cannot be recovered
+ */
+StorageEngine::StorageEngine() : rollupLsn(0), stopping(false) {
+  for (const auto& [series, policy] : ConfigLoader::RETENTION) {
+    retention[series] = parseRetention(policy);
+  }
+
+  recover();
+
+  // Retention updates the timestamp index from the background thread, so the index is created
+  // first and outlives the engine.
+  IndexManager::getInstance();
+  worker = std::thread(&StorageEngine::backgroundLoop, this);
+}
+
+/**
+ * @brief Stops the background thread and writes all memtables as runs.
+ */
+StorageEngine::~StorageEngine() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  workCv.notify_one();
+
+  if (worker.joinable()) {
+    worker.join();
+  }
+
+  try {
+    checkpoint();
+  }
+  catch (const std::exception& e) {
+    std::cerr << "Error: failed to write memtables: " << e.what() << "\n";
+  }
+}
+
+/**
+ * @brief Logs a record and inserts it into the memtable of its series.
+ *
+ * The record is queued to the log under the mutex, so records of a series reach the memtable in
+ * log order; waiting for the log commit happens outside of it.
+ *
+ * @param record
+ *   Measurement to store
+ *
+ * @throws std::runtime_error
+ *   If the write-ahead log cannot be written
+ */
+void StorageEngine::insert(const Measurement& record) {
+  WriteAheadLog& wal = WriteAheadLog::getInstance();
+  SegmentLog::getInstance().getComponentId(record.component);
+
+  uint64_t lsn;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    lsn = wal.enqueue(record);
+    insertLocked(lsn, record);
+    rollups.add(record);
+    rollupLsn = lsn;
+    if (wal.needsCheckpoint()) {
+      workCv.notify_one();
+    }
+  }
+
+  wal.waitFor(lsn);
+}
+
+/**
+ * @brief Reads the oldest or newest records of a series.
+ *
+ * @param series
+ *   Name of the component
+ * @param count
+ *   Number of records to read, 0 or less for all records
+ * @param fromStart
+ *   True to read the oldest records, false to read the newest ones
+ *
+ * @return std::vector<Measurement>
+ *   Records ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a run or the chunk file cannot be read
+ */
+std::vector<Measurement> StorageEngine::read(const std::string& series, int count,
+                                             bool fromStart) {
+  std::shared_lock<std::shared_mutex> files(filesMutex);
+  SeriesState state;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    state = getState(series);
+  }
+
+  return collectLive(series, state, count, fromStart);
+}
+
+/**
+ * @brief Reads records of a series with timestamps in the range [begin, end).
+ *
+ * @param series
+ *   Name of the component
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ *
+ * @return std::vector<Measurement>
+ *   Records ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a run or a partition cannot be read
+ */
+std::vector<Measurement> StorageEngine::readRange(const std::string& series, long long begin,
+                                                  long long end) {
+  std::shared_lock<std::shared_mutex> files(filesMutex);
+  SeriesState state;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    state = getState(series);
+  }
+
+  return collectRange(series, state, begin, end);
+}
+
+/**
+ * @brief Reads min/max/sum/count buckets of a series covering the range [begin, end).
+ *
+ * @param series
+ *   Name of the component
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ * @param step
+ *   Width of the buckets, in timestamp units
+ *
+ * @return std::vector<Rollup>
+ *   Buckets ordered by start
+ *
+ * @throws std::runtime_error
+ *   If step is not positive or the records cannot be read
+ */
+std::vector<Rollup> StorageEngine::readRollups(const std::string& series, long long begin,
+                                               long long end, long long step) {
+  if (step <= 0) {
+    throw std::runtime_error("Rollup step must be positive");
+  }
+
+  std::map<int64_t, Rollup> buckets;
+  auto addTo = [&](const Rollup& part) {
+    int64_t start = RollupStore::align(part.start, step);
+    RollupStore::combine(buckets.try_emplace(start, Rollup{start, 0.0, 0.0, 0.0, 0}).first->second,
+                         part);
+  };
+
+  int64_t first = RollupStore::align(begin, step);
+  int64_t width = step % RollupStore::HOUR == 0     ? RollupStore::HOUR
+                  : step % RollupStore::MINUTE == 0 ? RollupStore::MINUTE
+                                                    : 0;
+  if (width > 0) {
+    std::vector<Rollup> parts;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      parts = rollups.read(series, width, first, end);
+    }
+    for (const auto& part : parts) {
+      addTo(part);
+    }
+  }
+  else if (begin < end) {
+    for (const auto& m : readRange(series, first, RollupStore::align(end - 1, step) + step)) {
+      addTo({m.timestamp, m.temperature, m.temperature, m.temperature, 1});
+    }
+  }
+
+  std::vector<Rollup> result;
+  for (const auto& [start, bucket] : buckets) {
+    result.push_back(bucket);
+  }
+
+  return result;
+}
+
+/**
+ * @brief Finds records of a series with timestamps in the range [begin, end) and temperatures
+ * within [low, high].
+ *
+ * @param series
+ *   Name of the component
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ * @param low
+ *   Lowest matching temperature
+ * @param high
+ *   Highest matching temperature
+ *
+ * @return std::vector<Measurement>
+ *   Matching records ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a run or a partition cannot be read
+ */
+std::vector<Measurement> StorageEngine::findTemperature(const std::string& series,
+                                                        long long begin, long long end, double low,
+                                                        double high) {
+  std::shared_lock<std::shared_mutex> files(filesMutex);
+  SeriesState state;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    state = getState(series);
+  }
+
+  return collectRange(series, state, begin, end, low, high);
+}
+
+/**
+ * @brief Checks whether records of a series were ever stored by the engine.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return bool
+ *   True if the series is registered
+ */
+bool StorageEngine::exists(const std::string& series) {
+  std::vector<std::string> names = getSeries();
+
+  return std::find(names.begin(), names.end(), series) != names.end();
+}
+
+/**
+ * @brief Gets names of all series stored by the engine.
+ *
+ * @return std::vector<std::string>
+ *   Component names
+ */
+std::vector<std::string> StorageEngine::getSeries() {
+  return SegmentLog::getInstance().getSeries();
+}
+
+/**
+ * @brief Deletes the oldest or newest records of a series by writing a tombstone.
+ *
+ * The deleted records are contiguous in storage order, so the tombstone only records the first
+ * and the last of them; no data file is touched. The memtables are written out first and inserts
+ * keep going meanwhile: their records are newer than the tombstone. The background thread purges
+ * the dead records once PURGE_TOMBSTONES tombstones have been written, on its next maintenance
+ * pass.
+ *
+ * @param series
+ *   Name of the component
+ * @param count
+ *   Number of records to delete, 0 or less for all records
+ * @param fromStart
+ *   True to delete the oldest records, false to delete the newest ones
+ *
+ * @return std::vector<long long>
+ *   Timestamps of the deleted records
+ *
+ * @throws std::runtime_error
+ *   If a run or a partition cannot be read or the tombstones cannot be written
+ */
+std::vector<long long> StorageEngine::remove(const std::string& series, int count,
+                                             bool fromStart) {
+  std::unique_lock<std::shared_mutex> files(filesMutex);
+  uint64_t lsn;
+  SeriesState state = captureForRemoval(series, lsn);
+
+  std::vector<Measurement> records = collectLive(series, state, count, fromStart);
+  std::vector<long long> deletedTimestamps;
+  for (const auto& record : records) {
+    deletedTimestamps.push_back(record.timestamp);
+  }
+  if (!records.empty()) {
+    addTombstone(series, {records.front().timestamp, records.front().sequence,
+                          records.back().timestamp, records.back().sequence, lsn});
+  }
+
+  return deletedTimestamps;
+}
+
+/**
+ * @brief Deletes records of a series with timestamps in the range [begin, end) by writing a
+ * tombstone.
+ *
+ * Like remove(), only the tombstone is written; the records are located like readRange() does,
+ * so the cost depends on the number of deleted records rather than the length of the history.
+ *
+ * @param series
+ *   Name of the component
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ *
+ * @return std::vector<long long>
+ *   Timestamps of the deleted records
+ *
+ * @throws std::runtime_error
+ *   If a run or a partition cannot be read or the tombstones cannot be written
+ */
+std::vector<long long> StorageEngine::removeRange(const std::string& series, long long begin,
+                                                  long long end) {
+  std::unique_lock<std::shared_mutex> files(filesMutex);
+  uint64_t lsn;
+  SeriesState state = captureForRemoval(series, lsn);
+
+  std::vector<Measurement> records = collectRange(series, state, begin, end);
+  std::vector<long long> deletedTimestamps;
+  for (const auto& record : records) {
+    deletedTimestamps.push_back(record.timestamp);
+  }
+  if (!records.empty()) {
+    addTombstone(series, {records.front().timestamp, records.front().sequence,
+                          records.back().timestamp, records.back().sequence, lsn});
+  }
+
+  return deletedTimestamps;
+}
+
+/**
+ * @brief Deletes records of a series older than a timestamp.
+ *
+ * Records older than the timestamp are a prefix of every part, so the number of deleted records
+ * per part is counted without decoding whole partitions: only the partition holding the
+ * timestamp is read, runs are binary searched. Records hidden by tombstones were deleted before;
+ * only the span the tombstones cover is read to leave them out of the returned count.
+ *
+ * @param series
+ *   Name of the component
+ * @param timestamp
+ *   Oldest timestamp to keep
+ *
+ * @return size_t
+ *   Number of deleted records that were still visible
+ *
+ * @throws std::runtime_error
+ *   If a run or a partition cannot be rewritten
+ */
+size_t StorageEngine::dropBefore(const std::string& series, long long timestamp) {
+  SegmentLog& log = SegmentLog::getInstance();
+
+  std::unique_lock<std::shared_mutex> files(filesMutex);
+  SeriesState state;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    checkpointLocked();
+    state = getState(series);
+  }
+
+  std::vector<size_t> removed(1 + state.runs.size(), 0);
+  for (const auto& [partition, count] : state.partitions) {
+    if (partition + PARTITION_SECONDS <= timestamp) {
+      removed[0] += count;
+    }
+    else if (partition < timestamp) {
+      std::vector<Measurement> records;
+      ChunkStore(partition).read(series, 0, count, records);
+      removed[0] += std::count_if(records.begin(), records.end(),
+                                  [&](const Measurement& m) { return m.timestamp < timestamp; });
+    }
+  }
+
+  for (size_t i = 0; i < state.runs.size(); ++i) {
+    const Run& run = state.runs[i];
+    SegmentView records = log.view(getRunName(series, run.lsn), 0, run.count);
+    removed[i + 1] = findTimestamps(records, LLONG_MIN, timestamp).second;
+  }
+
+  size_t total = 0;
+  for (size_t count : removed) {
+    total += count;
+  }
+
+  long long first = timestamp, last = LLONG_MIN;
+  for (const auto& tombstone : state.tombstones) {
+    if (tombstone.first < timestamp) {
+      first = std::min(first, tombstone.first);
+      last = std::max(last, tombstone.last);
+    }
+  }
+
+  size_t hidden = 0;
+  if (first < timestamp) {
+    long long end = last < timestamp ? last + 1 : timestamp;
+    SeriesState unfiltered = state;
+    unfiltered.tombstones.clear();
+    hidden = collectRange(series, unfiltered, first, end).size() -
+             collectRange(series, state, first, end).size();
+  }
+
+  if (total > 0) {
+    applyRemoval(series, state, removed, true);
+  }
+
+  // Tombstones older than the timestamp cover nothing any more.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& list = tombstones[series];
+    auto expired = [&](const Tombstone& tombstone) { return tombstone.last < timestamp; };
+    list.erase(std::remove_if(list.begin(), list.end(), expired), list.end());
+
+    rollups.erase(series, LLONG_MIN, RollupStore::align(timestamp, RollupStore::HOUR));
+    refreshRollups(series, timestamp, timestamp);
+    rollups.save(rollupLsn);
+  }
+  saveTombstones();
+
+  return total - hidden;
+}
+
+/**
+ * @brief Writes all memtables as runs and empties the write-ahead log.
+ *
+ * @throws std::runtime_error
+ *   If a run or the write-ahead log cannot be written
+ */
+void StorageEngine::checkpoint() {
+  std::unique_lock<std::shared_mutex> files(filesMutex);
+  std::lock_guard<std::mutex> lock(mutex);
+  checkpointLocked();
+}
+
+/**
+ * @brief Brings files back to the state recorded by the manifest and replays the log.
+ *
+ * Partitions are cut back to the size recorded by the manifest and interrupted replacements are
+ * finished or discarded. Runs already merged into the partitions are removed. Log records newer
+ * than the newest run or compaction of their series are inserted into the memtables again, and
+ * records newer than the saved rollups are added to them; everything is then written out by a
+ * checkpoint.
+ *
+ * @throws std::runtime_error
+ *   If the manifest is unreadable or the files cannot be repaired
+ */
+void StorageEngine::recover() {
+  WriteAheadLog& wal = WriteAheadLog::getInstance();
+  SegmentLog& log = SegmentLog::getInstance();
+  ensureDataDirectoryExists(getDataDirectory());
+  ensureDataDirectoryExists(log.getSegmentDirectory());
+
+  nlohmann::json state = wal.getCheckpoint();
+  nlohmann::json recordedChunks = nlohmann::json::object();
+  bool known = false;
+  try {
+    std::ifstream file(getManifestPath());
+    if (file) {
+      nlohmann::json manifest;
+      file >> manifest;
+      recordedChunks = manifest["chunks"];
+      compactedLsn = manifest["compacted"].get<std::unordered_map<std::string, uint64_t>>();
+      known = true;
+    }
+  }
+  catch (...) {
+    throw std::runtime_error("Storage manifest is unreadable: " + getManifestPath());
+  }
+
+  // Checkpoints of older versions recorded the chunk sizes themselves.
+  if (!known && state.is_object() && state.contains("chunks")) {
+    recordedChunks = state["chunks"];
+    known = true;
+  }
+
+  loadTombstones();
+
+  std::vector<std::string> migrated;
+  for (const auto& series : log.getSeries()) {
+    nlohmann::json recorded = recordedChunks.value(series, nlohmann::json());
+
+    for (int64_t partition : ChunkStore::listPartitions(series)) {
+      ChunkStore chunks(partition);
+      size_t expected = 0;
+      if (recorded.is_object()) {
+        expected = recorded.value(std::to_string(partition), size_t(0));
+      }
+
+      chunks.recoverStaged(series, expected);
+      chunks.truncate(series, expected);
+      size_t count = chunks.count(series);
+      if (count > 0) {
+        partitions[series][partition] = count;
+        chunks.buildZones(series);
+      }
+      else {
+        chunks.remove(series);
+      }
+    }
+
+    // Older versions kept the whole history in one chunk file, recorded by its size.
+    ChunkStore unpartitioned;
+    if (access(unpartitioned.getChunkPath(series).c_str(), F_OK) == 0) {
+      if (recorded.is_object()) {
+        // Already split before a crash.
+        unpartitioned.remove(series);
+      }
+      else {
+        size_t expected = recorded.is_number() ? recorded.get<size_t>() : known ? 0 : SIZE_MAX;
+        unpartitioned.recoverStaged(series, expected);
+        // Without a recorded size only a torn tail is dropped.
+        unpartitioned.truncate(series, expected);
+        migrateChunks(series);
+        migrated.push_back(series);
+      }
+    }
+
+    if (log.exists(series)) {
+      migrateSegment(series, state);
+    }
+  }
+  saveManifest();
+
+  for (const auto& series : migrated) {
+    ChunkStore().remove(series);
+  }
+
+  loadRuns();
+
+  std::unordered_map<std::string, uint64_t> flushedLsn = compactedLsn;
+  for (auto& [series, list] : runs) {
+    auto merged = std::remove_if(list.begin(), list.end(), [&](const Run& run) {
+      if (run.lsn > compactedLsn[series]) {
+        return false;
+      }
+      log.remove(getRunName(series, run.lsn));
+
+      return true;
+    });
+    list.erase(merged, list.end());
+
+    for (const auto& run : list) {
+      flushedLsn[series] = std::max(flushedLsn[series], run.lsn);
+    }
+  }
+
+  std::unordered_map<std::string, uint64_t> rolledLsn;
+  std::set<std::string> unrolled;
+  for (const auto& series : log.getSeries()) {
+    uint64_t lsn = 0;
+    if (rollups.load(series, lsn)) {
+      rolledLsn[series] = lsn;
+      rollupLsn = std::max(rollupLsn, lsn);
+    }
+    else {
+      unrolled.insert(series);
+    }
+  }
+
+  std::unordered_map<std::string, std::vector<long long>> touched;
+  size_t replayed = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    wal.replay([&](uint64_t lsn, const Measurement& record) {
+      auto rolled = rolledLsn.find(record.component);
+      if (rolled == rolledLsn.end()) {
+        unrolled.insert(record.component);
+      }
+      else if (lsn > rolled->second) {
+        rollups.add(record);
+      }
+      rollupLsn = std::max(rollupLsn, lsn);
+
+      auto it = flushedLsn.find(record.component);
+      if (it != flushedLsn.end() && lsn <= it->second) {
+        return;
+      }
+
+      log.getComponentId(record.component);
+      insertLocked(lsn, record);
+      touched[record.component].push_back(record.timestamp);
+      ++replayed;
+    });
+  }
+
+  // Replayed records may have been stored without being indexed; legacy JSON records stay indexed.
+  for (auto& [series, timestamps] : touched) {
+    IndexManager::getInstance().mergeIndex(series, std::move(timestamps));
+  }
+
+  // Rollups are missing after an upgrade or damage; they are rebuilt from the records once.
+  for (const auto& series : unrolled) {
+    std::vector<Measurement> records = read(series, 0, true);
+    std::lock_guard<std::mutex> lock(mutex);
+    rollups.erase(series, LLONG_MIN, LLONG_MAX);
+    for (const auto& record : records) {
+      rollups.add(record);
+    }
+  }
+
+  // Deletes since the last checkpoint are not reflected in the saved rollups.
+  {
+    std::unique_lock<std::shared_mutex> files(filesMutex);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [series, list] : tombstones) {
+      if (unrolled.count(series) == 0) {
+        for (const auto& tombstone : list) {
+          refreshRollups(series, tombstone.first, tombstone.last);
+        }
+      }
+    }
+  }
+
+  checkpoint();
+
+  // Tombstones of older versions hide whole timestamps, whenever their records were stored; they
+  // are purged before anything can be stored behind them.
+  {
+    std::unique_lock<std::shared_mutex> files(filesMutex);
+    std::vector<std::string> outdated;
+    for (const auto& [series, list] : tombstones) {
+      if (std::any_of(list.begin(), list.end(),
+                      [](const Tombstone& tombstone) { return tombstone.lsn == UINT64_MAX; })) {
+        outdated.push_back(series);
+      }
+    }
+    for (const auto& series : outdated) {
+      purge(series);
+    }
+  }
+
+  if (replayed > 0) {
+    std::cout << "Recovered " << replayed << " record(s) from the write-ahead log.\n";
+  }
+}
+
+/**
+ * @brief Migrates a segment written record by record by older versions into a run.
+ *
+ * The segment is cut back to the size recorded by the old checkpoint, which the log tail is
+ * replayed on top of, and rewritten sorted as a run named after the checkpoint.
+ *
+ * @param series
+ *   Name of the component
+ * @param state
+ *   Checkpoint written by the older version
+ *
+ * @throws std::runtime_error
+ *   If the segment cannot be migrated
+ */
+void StorageEngine::migrateSegment(const std::string& series, const nlohmann::json& state) {
+  SegmentLog& log = SegmentLog::getInstance();
+  uint64_t lsn = 0;
+
+  if (state.is_object()) {
+    lsn = state.value("lsn", uint64_t(0));
+    if (state.contains("segments")) {
+      log.truncate(series, state["segments"].value(series, size_t(0)));
+    }
+  }
+
+  std::vector<Measurement> records = log.read(series, 0, log.count(series));
+  if (!records.empty()) {
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Measurement& a, const Measurement& b) {
+                       return a.timestamp < b.timestamp;
+                     });
+    log.rewrite(getRunName(series, lsn), records);
+  }
+  log.remove(series);
+}
+
+/**
+ * @brief Splits the unpartitioned chunk file of older versions into partitions.
+ *
+ * The partitions are written durably; the caller records them in the manifest before it removes
+ * the old file.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @throws std::runtime_error
+ *   If the old file cannot be read or a partition cannot be written
+ */
+void StorageEngine::migrateChunks(const std::string& series) {
+  ChunkStore unpartitioned;
+  std::vector<Measurement> records;
+  unpartitioned.read(series, 0, unpartitioned.count(series), records);
+
+  std::map<int64_t, std::vector<Measurement>> groups;
+  for (const auto& record : records) {
+    groups[getPartition(record.timestamp)].push_back(record);
+  }
+
+  for (const auto& [partition, group] : groups) {
+    ChunkStore(partition).replace(series, group);
+    partitions[series][partition] = group.size();
+  }
+}
+
+/**
+ * @brief Finds runs in the segments directory.
+ *
+ * @throws std::runtime_error
+ *   If the segments directory cannot be read
+ */
+void StorageEngine::loadRuns() {
+  SegmentLog& log = SegmentLog::getInstance();
+  std::string extension = SegmentLog::SEGMENT_EXTENSION;
+
+  DIR* dir = opendir(log.getSegmentDirectory().c_str());
+  if (!dir) {
+    throw std::runtime_error("Cannot read segments directory: " + log.getSegmentDirectory());
+  }
+
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() <= extension.size() ||
+        name.compare(name.size() - extension.size(), extension.size(), extension) != 0) {
+      continue;
+    }
+
+    std::string stem = name.substr(0, name.size() - extension.size());
+    size_t dot = stem.rfind('.');
+    if (dot == std::string::npos || stem.size() - dot - 1 != LSN_DIGITS ||
+        !std::all_of(stem.begin() + dot + 1, stem.end(), ::isdigit)) {
+      continue;
+    }
+
+    std::string series = stem.substr(0, dot);
+    uint64_t lsn = std::stoull(stem.substr(dot + 1));
+    runs[series].push_back({lsn, log.count(stem)});
+  }
+  closedir(dir);
+
+  for (auto& [series, list] : runs) {
+    std::sort(list.begin(), list.end(), [](const Run& a, const Run& b) { return a.lsn < b.lsn; });
+  }
+}
+
+/**
+ * @brief Inserts a logged record into the memtable of its series, freezing a full memtable.
+ *
+ * @param lsn
+ *   Log sequence number of the record
+ * @param record
+ *   Measurement to insert
+ */
+void StorageEngine::insertLocked(uint64_t lsn, const Measurement& record) {
+  MemTable& table = memtables[record.component];
+  auto& records = table.records;
+
+  if (records.empty() || records.back().timestamp <= record.timestamp) {
+    records.push_back(record);
+  }
+  else {
+    auto position = std::upper_bound(
+        records.begin(), records.end(), record,
+        [](const Measurement& a, const Measurement& b) { return a.timestamp < b.timestamp; });
+    records.insert(position, record);
+  }
+  table.lsn = lsn;
+
+  if (records.size() >= MEMTABLE_RECORDS) {
+    frozen.emplace_back(record.component, std::move(table));
+    memtables.erase(record.component);
+    workCv.notify_one();
+  }
+}
+
+/**
+ * @brief Background loop writing frozen memtables, taking checkpoints, compacting runs and
+ * purging deleted records.
+ *
+ * The loop wakes up when a memtable is frozen or the log needs a checkpoint, and at least every
+ * MAINTENANCE_INTERVAL to look for series due for compaction or purging. Retention is enforced
+ * every RETENTION_INTERVAL.
+ */
+void StorageEngine::backgroundLoop() {
+  WriteAheadLog& wal = WriteAheadLog::getInstance();
+  auto nextRetention = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (!stopping) {
+    workCv.wait_for(lock, MAINTENANCE_INTERVAL,
+                    [&] { return stopping || !frozen.empty() || wal.needsCheckpoint(); });
+    if (stopping) {
+      break;
+    }
+    lock.unlock();
+
+    bool ok = true;
+    try {
+      if (std::chrono::steady_clock::now() >= nextRetention) {
+        nextRetention = std::chrono::steady_clock::now() + RETENTION_INTERVAL;
+        enforceRetention();
+      }
+
+      std::unique_lock<std::shared_mutex> files(filesMutex);
+      flushFrozen();
+
+      std::vector<std::string> due;
+      std::vector<std::string> deleted;
+      {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (wal.needsCheckpoint()) {
+          checkpointLocked();
+        }
+        for (const auto& [series, list] : runs) {
+          if (list.size() >= COMPACTION_RUNS) {
+            due.push_back(series);
+          }
+        }
+
+        // Compaction moves records newer than the tombstones of a series into partitions, so
+        // the series is purged first.
+        size_t total = 0;
+        for (const auto& [series, list] : tombstones) {
+          total += list.size();
+        }
+        for (const auto& [series, list] : tombstones) {
+          bool compacting = std::find(due.begin(), due.end(), series) != due.end();
+          if (!list.empty() && (total >= PURGE_TOMBSTONES || compacting)) {
+            deleted.push_back(series);
+          }
+        }
+      }
+
+      for (const auto& series : deleted) {
+        purge(series);
+      }
+      for (const auto& series : due) {
+        compact(series);
+      }
+    }
+    catch (const std::exception& e) {
+      std::cerr << "Error: storage maintenance failed: " << e.what() << "\n";
+      ok = false;
+    }
+
+    lock.lock();
+    if (!ok) {
+      // Retrying right away would spin while the failure persists.
+      workCv.wait_for(lock, MAINTENANCE_INTERVAL, [&] { return stopping; });
+    }
+  }
+}
+
+/**
+ * @brief Drops partitions and rollup buckets older than the retention policy of every series.
+ *
+ * Series without a policy of their own follow the one of their component, so the
+ * "<Component>@<Host>" series of polled hosts share RETENTION_<Component>, and then the default
+ * one. Index entries of the dropped records are removed right away. Expired rollup buckets are
+ * saved by the next checkpoint; if they come back after a crash they are dropped again.
+ *
+ * @throws std::runtime_error
+ *   If a partition or the manifest cannot be written
+ */
+void StorageEngine::enforceRetention() {
+  long long now = std::time(nullptr);
+
+  for (const auto& series : getSeries()) {
+    auto it = retention.find(series);
+    if (it == retention.end()) {
+      it = retention.find(series.substr(0, series.find('@')));
+    }
+    if (it == retention.end()) {
+      it = retention.find("");
+    }
+    if (it == retention.end()) {
+      continue;
+    }
+    const Retention& policy = it->second;
+
+    if (policy.raw > 0) {
+      long long kept = dropPartitions(series, now - policy.raw);
+      if (kept != LLONG_MIN) {
+        // Runs and memtables may still hold records older than the kept partitions.
+        std::vector<Measurement> oldest = read(series, 1, true);
+        if (!oldest.empty()) {
+          kept = std::min(kept, oldest.front().timestamp);
+        }
+        IndexManager::getInstance().deleteOlderThan(series, kept);
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (policy.minute > 0) {
+      rollups.expire(series, RollupStore::MINUTE, now - policy.minute);
+    }
+    if (policy.hour > 0) {
+      rollups.expire(series, RollupStore::HOUR, now - policy.hour);
+    }
+  }
+}
+
+/**
+ * @brief Removes partitions of a series that hold only records older than a timestamp.
+ *
+ * Records still in runs or memtables are left alone until compaction moves them into a partition.
+ * The manifest is saved before the files are removed, so recovery never expects a missing file.
+ * Rollups are kept. Tombstones are purged first, since dropping records of a timestamp that runs
+ * still hold would shift the sequences the tombstones refer to.
+ *
+ * @param series
+ *   Name of the component
+ * @param timestamp
+ *   Oldest timestamp to keep
+ *
+ * @return long long
+ *   Start of the oldest kept partition, or LLONG_MIN if nothing was removed
+ *
+ * @throws std::runtime_error
+ *   If a partition or the manifest cannot be written
+ */
+long long StorageEngine::dropPartitions(const std::string& series, long long timestamp) {
+  std::unique_lock<std::shared_mutex> files(filesMutex);
+  bool expired;
+  bool deleted;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto& list = partitions[series];
+    expired = !list.empty() && list.begin()->first + PARTITION_SECONDS <= timestamp;
+    deleted = !tombstones[series].empty();
+  }
+  if (!expired) {
+    return LLONG_MIN;
+  }
+  if (deleted) {
+    purge(series);
+  }
+
+  std::vector<int64_t> dropped;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& list = partitions[series];
+    while (!list.empty() && list.begin()->first + PARTITION_SECONDS <= timestamp) {
+      dropped.push_back(list.begin()->first);
+      list.erase(list.begin());
+    }
+  }
+  if (dropped.empty()) {
+    return LLONG_MIN;
+  }
+
+  saveManifest();
+  for (int64_t partition : dropped) {
+    ChunkStore(partition).remove(series);
+  }
+
+  return dropped.back() + PARTITION_SECONDS;
+}
+
+/**
+ * @brief Parses a retention policy such as "raw:7d, minute:90d, hour:forever".
+ *
+ * @param value
+ *   Policy from the configuration
+ *
+ * @return Retention
+ *   Parsed policy
+ *
+ * @throws std::invalid_argument
+ *   If the policy is malformed
+ */
+StorageEngine::Retention StorageEngine::parseRetention(const std::string& value) {
+  static const std::map<std::string, long long> UNITS = {
+      {"s", 1}, {"m", 60}, {"h", 60 * 60}, {"d", 24 * 60 * 60}, {"w", 7 * 24 * 60 * 60}};
+
+  Retention policy;
+  std::istringstream list(value);
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    item = ConfigLoader::trim(item);
+    if (item.empty()) {
+      continue;
+    }
+
+    size_t colon = item.find(':');
+    if (colon == std::string::npos) {
+      throw std::invalid_argument("Invalid retention policy: " + value);
+    }
+    std::string tier = ConfigLoader::trim(item.substr(0, colon));
+    std::string period = ConfigLoader::trim(item.substr(colon + 1));
+
+    long long age = 0;
+    if (period != "forever") {
+      size_t digits = 0;
+      while (digits < period.size() && std::isdigit(static_cast<unsigned char>(period[digits]))) {
+        ++digits;
+      }
+      auto unit = UNITS.find(period.substr(digits));
+      if (digits == 0 || digits > 12 || unit == UNITS.end()) {
+        throw std::invalid_argument("Invalid retention period: " + period);
+      }
+      age = std::stoll(period.substr(0, digits)) * unit->second;
+      if (age <= 0) {
+        throw std::invalid_argument("Invalid retention period: " + period);
+      }
+    }
+
+    if (tier == "raw") {
+      policy.raw = age;
+    }
+    else if (tier == "minute") {
+      policy.minute = age;
+    }
+    else if (tier == "hour") {
+      policy.hour = age;
+    }
+    else {
+      throw std::invalid_argument("Unknown retention tier: " + tier);
+    }
+  }
+
+  return policy;
+}
+
+/**
+ * @brief Writes frozen memtables as runs, from the oldest.
+ *
+ * Inserts may freeze more memtables meanwhile; they are appended behind the one being written.
+ *
+ * @throws std::runtime_error
+ *   If a run cannot be written
+ */
+void StorageEngine::flushFrozen() {
+  SegmentLog& log = SegmentLog::getInstance();
+
+  while (true) {
+    std::pair<std::string, MemTable> item;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (frozen.empty()) {
+        return;
+      }
+      item = frozen.front();
+    }
+
+    // Records of a run are not replayed on recovery, so their index entries are flushed first.
+    IndexManager::getInstance().flushJournal();
+    log.rewrite(getRunName(item.first, item.second.lsn), item.second.records);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    runs[item.first].push_back({item.second.lsn, item.second.records.size()});
+    frozen.erase(frozen.begin());
+  }
+}
+
+/**
+ * @brief Writes all memtables as runs and empties the write-ahead log.
+ *
+ * Holding the mutex keeps inserts out, so every logged record is in a run once the log is
+ * emptied.
+ *
+ * @throws std::runtime_error
+ *   If a run or the write-ahead log cannot be written
+ */
+void StorageEngine::checkpointLocked() {
+  SegmentLog& log = SegmentLog::getInstance();
+
+  for (auto& [series, table] : memtables) {
+    frozen.emplace_back(series, std::move(table));
+  }
+  memtables.clear();
+  IndexManager::getInstance().flushJournal();
+
+  while (!frozen.empty()) {
+    const auto& [series, table] = frozen.front();
+    log.rewrite(getRunName(series, table.lsn), table.records);
+    runs[series].push_back({table.lsn, table.records.size()});
+    frozen.erase(frozen.begin());
+  }
+
+  // Logged records newer than the saved rollups are added again on replay.
+  rollups.save(rollupLsn);
+  WriteAheadLog::getInstance().checkpoint();
+}
+
+/**
+ * @brief Merges all runs of a series into its partitions.
+ *
+ * Merged records are split by partition and appended as new chunks. If a partition already holds
+ * records newer than the oldest appended one, it is rebuilt instead; the new file is staged, the
+ * manifest is written and only then the file is installed, so recovery can tell which of the two
+ * is valid. Runs are removed once the manifest records their sequence number as compacted.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @throws std::runtime_error
+ *   If a run, a partition or the manifest cannot be read or written
+ */
+void StorageEngine::compact(const std::string& series) {
+  SegmentLog& log = SegmentLog::getInstance();
+
+  std::vector<Run> batch;
+  std::map<int64_t, size_t> counts;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    batch = runs[series];
+    counts = partitions[series];
+  }
+  if (batch.size() < COMPACTION_RUNS) {
+    return;
+  }
+
+  std::vector<std::vector<Measurement>> parts;
+  for (const auto& run : batch) {
+    parts.push_back(log.read(getRunName(series, run.lsn), 0, run.count));
+  }
+
+  MergeIterator merged(std::move(parts));
+  std::map<int64_t, std::vector<Measurement>> groups;
+  Measurement record;
+  while (merged.next(record)) {
+    groups[getPartition(record.timestamp)].push_back(record);
+  }
+
+  std::vector<int64_t> staged;
+  for (auto& [partition, records] : groups) {
+    ChunkStore chunks(partition);
+    size_t base = counts[partition];
+
+    std::vector<Measurement> newest;
+    if (base > 0 && !chunks.readLast(series, 1, newest)) {
+      chunks.read(series, base - 1, base, newest);
+    }
+
+    if (newest.empty() || records.front().timestamp >= newest.back().timestamp) {
+      chunks.append(series, records);
+      counts[partition] = base + records.size();
+      continue;
+    }
+
+    std::vector<Measurement> history;
+    chunks.read(series, 0, base, history);
+
+    MergeIterator rebuilt({std::move(history), std::move(records)});
+    std::vector<Measurement> all;
+    while (rebuilt.next(record)) {
+      all.push_back(record);
+    }
+    chunks.stage(series, all);
+    counts[partition] = all.size();
+    staged.push_back(partition);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    partitions[series] = counts;
+    compactedLsn[series] = batch.back().lsn;
+    auto& list = runs[series];
+    list.erase(list.begin(), list.begin() + batch.size());
+  }
+  saveManifest();
+
+  for (int64_t partition : staged) {
+    ChunkStore(partition).commitStaged(series);
+  }
+  for (const auto& run : batch) {
+    log.remove(getRunName(series, run.lsn));
+  }
+}
+
+/**
+ * @brief Deletes the oldest or newest records of every part of a series.
+ *
+ * Partitions and runs that lose all their records are removed without being read; only the
+ * ones cut in the middle are rewritten.
+ *
+ * @param series
+ *   Name of the component
+ * @param state
+ *   Parts of the series, updated to the new state
+ * @param removed
+ *   Number of records to delete from the partitions, followed by one count per run
+ * @param fromStart
+ *   True to delete the oldest records, false to delete the newest ones
+ *
+ * @throws std::runtime_error
+ *   If a run, a partition or the manifest cannot be written
+ */
+void StorageEngine::applyRemoval(const std::string& series, SeriesState& state,
+                                 const std::vector<size_t>& removed, bool fromStart) {
+  SegmentLog& log = SegmentLog::getInstance();
+
+  size_t left = removed[0];
+  while (left > 0 && !state.partitions.empty()) {
+    auto it = fromStart ? state.partitions.begin() : std::prev(state.partitions.end());
+    ChunkStore chunks(it->first);
+
+    if (left >= it->second) {
+      chunks.remove(series);
+      left -= it->second;
+      state.partitions.erase(it);
+      continue;
+    }
+
+    std::vector<Measurement> history;
+    chunks.read(series, 0, it->second, history);
+    if (fromStart) {
+      history.erase(history.begin(), history.begin() + left);
+    }
+    else {
+      history.resize(history.size() - left);
+    }
+    chunks.replace(series, history);
+    it->second = history.size();
+    left = 0;
+  }
+
+  std::vector<Run> kept;
+  for (size_t i = 0; i < state.runs.size(); ++i) {
+    Run run = state.runs[i];
+    std::string name = getRunName(series, run.lsn);
+    size_t k = removed[i + 1];
+
+    if (k == run.count) {
+      log.remove(name);
+      continue;
+    }
+
+    if (k > 0) {
+      std::vector<Measurement> records = log.read(name, 0, run.count);
+      if (fromStart) {
+        records.erase(records.begin(), records.begin() + k);
+      }
+      else {
+        records.resize(records.size() - k);
+      }
+      log.rewrite(name, records);
+      run.count = records.size();
+    }
+    kept.push_back(run);
+  }
+  state.runs = kept;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    partitions[series] = state.partitions;
+    runs[series] = state.runs;
+  }
+  saveManifest();
+}
+
+/**
+ * @brief Writes a tombstone of a series and refreshes the rollups it touched.
+ *
+ * @param series
+ *   Name of the component
+ * @param tombstone
+ *   Deleted records
+ *
+ * @throws std::runtime_error
+ *   If the tombstones cannot be written
+ */
+void StorageEngine::addTombstone(const std::string& series, const Tombstone& tombstone) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    tombstones[series].push_back(tombstone);
+  }
+  saveTombstones();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  refreshRollups(series, tombstone.first, tombstone.last);
+}
+
+/**
+ * @brief Writes the memtables out and captures the parts of a series together with the newest
+ * log sequence number stored in it.
+ *
+ * Once the memtables are written, every record of the series is in a partition or a run whose
+ * number a tombstone can compare with; records inserted afterwards get higher numbers.
+ *
+ * @param series
+ *   Name of the component
+ * @param lsn
+ *   Receives the newest log sequence number stored in the series
+ *
+ * @return SeriesState
+ *   Partitions, runs and tombstones of the series
+ *
+ * @throws std::runtime_error
+ *   If a run or the write-ahead log cannot be written
+ */
+StorageEngine::SeriesState StorageEngine::captureForRemoval(const std::string& series,
+                                                            uint64_t& lsn) {
+  std::lock_guard<std::mutex> lock(mutex);
+  checkpointLocked();
+  SeriesState state = getState(series);
+
+  auto compacted = compactedLsn.find(series);
+  lsn = compacted != compactedLsn.end() ? compacted->second : 0;
+  if (!state.runs.empty()) {
+    lsn = std::max(lsn, state.runs.back().lsn);
+  }
+
+  return state;
+}
+
+/**
+ * @brief Physically removes records covered by tombstones from a series and drops them.
+ *
+ * Partitions not overlapping any tombstone are left untouched; the others are merged with all
+ * runs, which gives every record of a deleted timestamp its sequence. Data files are rewritten
+ * first, then the manifest and finally the tombstones, so a crash in between only repeats the
+ * purge.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @throws std::runtime_error
+ *   If a run, a partition, the manifest or the tombstones cannot be written
+ */
+void StorageEngine::purge(const std::string& series) {
+  SegmentLog& log = SegmentLog::getInstance();
+
+  SeriesState state;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    checkpointLocked();
+    state = getState(series);
+  }
+  if (state.tombstones.empty()) {
+    return;
+  }
+
+  auto overlaps = [&](long long first, long long last) {
+    for (const auto& tombstone : state.tombstones) {
+      if (tombstone.first <= last && tombstone.last >= first) {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  // Overlapping partitions, one part each, followed by the runs from the oldest.
+  std::vector<int64_t> touched;
+  std::vector<std::vector<Measurement>> parts;
+  std::vector<uint64_t> lsns;
+  for (const auto& [partition, count] : state.partitions) {
+    if (overlaps(partition, partition + PARTITION_SECONDS - 1)) {
+      touched.push_back(partition);
+      parts.emplace_back();
+      ChunkStore(partition).read(series, 0, count, parts.back());
+      lsns.push_back(0);
+    }
+  }
+  for (const auto& run : state.runs) {
+    parts.push_back(log.read(getRunName(series, run.lsn), 0, run.count));
+    lsns.push_back(run.lsn);
+  }
+
+  MergeIterator merged(std::move(parts));
+  std::vector<std::vector<Measurement>> kept(lsns.size());
+  Measurement record;
+  size_t part;
+  long long previous = LLONG_MIN;
+  size_t sequence = 0;
+  while (merged.next(record, part)) {
+    sequence = record.timestamp == previous ? sequence + 1 : 0;
+    previous = record.timestamp;
+    if (!isDeleted(state.tombstones, record.timestamp, sequence, lsns[part])) {
+      kept[part].push_back(record);
+    }
+  }
+
+  for (size_t i = 0; i < touched.size(); ++i) {
+    ChunkStore chunks(touched[i]);
+    size_t& count = state.partitions[touched[i]];
+    if (kept[i].empty()) {
+      chunks.remove(series);
+      state.partitions.erase(touched[i]);
+    }
+    else if (kept[i].size() < count) {
+      chunks.replace(series, kept[i]);
+      count = kept[i].size();
+    }
+  }
+
+  std::vector<Run> runsKept;
+  for (size_t i = 0; i < state.runs.size(); ++i) {
+    Run run = state.runs[i];
+    const auto& records = kept[touched.size() + i];
+    std::string name = getRunName(series, run.lsn);
+    if (records.empty()) {
+      log.remove(name);
+      continue;
+    }
+    if (records.size() < run.count) {
+      log.rewrite(name, records);
+      run.count = records.size();
+    }
+    runsKept.push_back(run);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    partitions[series] = state.partitions;
+    runs[series] = runsKept;
+    tombstones.erase(series);
+  }
+  saveManifest();
+  saveTombstones();
+}
+
+/**
+ * @brief Recomputes the rollups of a series after records between two timestamps were deleted.
+ *
+ * Records inserted after a delete may lie between its ends, so every hour spanned by the
+ * timestamps is rebuilt from the remaining records.
+ *
+ * @param series
+ *   Name of the component
+ * @param first
+ *   Oldest deleted timestamp
+ * @param last
+ *   Newest deleted timestamp
+ *
+ * @throws std::runtime_error
+ *   If a run or a partition cannot be read
+ */
+void StorageEngine::refreshRollups(const std::string& series, long long first, long long last) {
+  int64_t begin = RollupStore::align(first, RollupStore::HOUR);
+  int64_t end = RollupStore::align(last, RollupStore::HOUR) + RollupStore::HOUR;
+  rollups.erase(series, begin, end);
+
+  SeriesState state = getState(series);
+  for (const auto& record : collectRange(series, state, begin, end)) {
+    rollups.add(record);
+  }
+}
+
+/**
+ * @brief Captures the parts of a series.
+ *
+ * @param series
+ *   Name of the component
+ *
+ * @return SeriesState
+ *   Partitions, runs, buffered records and tombstones of the series
+ */
+StorageEngine::SeriesState StorageEngine::getState(const std::string& series) const {
+  SeriesState state;
+
+  auto partitionIt = partitions.find(series);
+  if (partitionIt != partitions.end()) {
+    state.partitions = partitionIt->second;
+  }
+
+  auto runIt = runs.find(series);
+  if (runIt != runs.end()) {
+    state.runs = runIt->second;
+  }
+
+  for (const auto& [name, table] : frozen) {
+    if (name == series) {
+      state.buffered.push_back(table.records);
+    }
+  }
+
+  auto tableIt = memtables.find(series);
+  if (tableIt != memtables.end()) {
+    state.buffered.push_back(tableIt->second.records);
+  }
+
+  auto tombstoneIt = tombstones.find(series);
+  if (tombstoneIt != tombstones.end()) {
+    state.tombstones = tombstoneIt->second;
+  }
+
+  return state;
+}
+
+/**
+ * @brief Reads the records of every part of a series that can belong to its oldest or newest
+ * records.
+ *
+ * @param series
+ *   Name of the component
+ * @param state
+ *   Parts of the series
+ * @param count
+ *   Number of records needed, 0 or less for all records
+ * @param fromStart
+ *   True for the oldest records, false for the newest ones
+ *
+ * @return std::vector<std::vector<Measurement>>
+ *   Records of every part, each ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a run or the chunk file cannot be read
+ */
+std::vector<std::vector<Measurement>> StorageEngine::collectParts(const std::string& series,
+                                                                  const SeriesState& state,
+                                                                  int count,
+                                                                  bool fromStart) const {
+  SegmentLog& log = SegmentLog::getInstance();
+  std::vector<std::vector<Measurement>> parts(1);
+
+  // Partitions are disjoint and ordered, so they are only read until count records are found.
+  size_t needed = count > 0 ? count : SIZE_MAX;
+  std::vector<std::vector<Measurement>> newest;
+  auto readPartition = [&](int64_t partition, size_t total, std::vector<Measurement>& out) {
+    ChunkStore chunks(partition);
+    size_t taken = std::min(needed, total);
+    size_t begin = fromStart ? 0 : total - taken;
+    if (fromStart || !chunks.readLast(series, taken, out)) {
+      chunks.read(series, begin, begin + taken, out);
+    }
+    if (count > 0) {
+      needed -= taken;
+    }
+  };
+
+  if (fromStart) {
+    for (auto it = state.partitions.begin(); it != state.partitions.end() && needed > 0; ++it) {
+      readPartition(it->first, it->second, parts[0]);
+    }
+  }
+  else {
+    for (auto it = state.partitions.rbegin(); it != state.partitions.rend() && needed > 0; ++it) {
+      newest.emplace_back();
+      readPartition(it->first, it->second, newest.back());
+    }
+    for (auto it = newest.rbegin(); it != newest.rend(); ++it) {
+      parts[0].insert(parts[0].end(), it->begin(), it->end());
+    }
+  }
+
+  for (const auto& run : state.runs) {
+    auto [first, last] = selectRange(run.count, count, fromStart);
+    parts.push_back(log.read(getRunName(series, run.lsn), first, last));
+  }
+
+  for (const auto& records : state.buffered) {
+    auto [first, last] = selectRange(records.size(), count, fromStart);
+    parts.emplace_back(records.begin() + first, records.begin() + last);
+  }
+
+  return parts;
+}
+
+/**
+ * @brief Reads the oldest or newest live records of a series.
+ *
+ * Every part holds its records ordered by timestamp, so only the first or last count records of
+ * each part are read before they are merged. Records covered by tombstones are skipped; if they
+ * leave fewer than count records, the read is repeated with a larger count.
+ *
+ * @param series
+ *   Name of the component
+ * @param state
+ *   Parts of the series
+ * @param count
+ *   Number of records to read, 0 or less for all records
+ * @param fromStart
+ *   True to read the oldest records, false to read the newest ones
+ *
+ * @return std::vector<Measurement>
+ *   Records ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a run or the chunk file cannot be read
+ */
+std::vector<Measurement> StorageEngine::collectLive(const std::string& series,
+                                                    const SeriesState& state, int count,
+                                                    bool fromStart) const {
+  std::vector<uint64_t> partLsns = getPartLsns(state);
+  int fetch = count;
+  while (true) {
+    MergeIterator merged(collectParts(series, state, fetch, fromStart));
+    std::vector<Measurement> records;
+    std::vector<uint64_t> lsns;
+    Measurement record;
+    size_t part;
+    while ((fetch <= 0 || !fromStart || records.size() < static_cast<size_t>(fetch)) &&
+           merged.next(record, part)) {
+      records.push_back(record);
+      lsns.push_back(partLsns[part]);
+    }
+
+    if (fetch > 0 && records.size() > static_cast<size_t>(fetch)) {
+      records.erase(records.begin(), records.end() - fetch);
+      lsns.erase(lsns.begin(), lsns.end() - fetch);
+    }
+    bool exhausted = fetch <= 0 || records.size() < static_cast<size_t>(fetch);
+
+    // The newest records may begin in the middle of a timestamp, whose sequences are unknown.
+    if (!fromStart && !exhausted) {
+      size_t partial = 0;
+      while (partial < records.size() && records[partial].timestamp == records.front().timestamp) {
+        ++partial;
+      }
+      records.erase(records.begin(), records.begin() + partial);
+      lsns.erase(lsns.begin(), lsns.begin() + partial);
+    }
+
+    std::vector<Measurement> result = dropDeleted(records, lsns, state.tombstones);
+
+    // Deleted records took the place of live ones; read further until enough are found.
+    if (count > 0 && result.size() < static_cast<size_t>(count) && !exhausted) {
+      fetch = fetch > INT_MAX / 2 ? 0 : fetch * 2;
+      continue;
+    }
+
+    if (count > 0 && result.size() > static_cast<size_t>(count)) {
+      if (fromStart) {
+        result.resize(count);
+      }
+      else {
+        result.erase(result.begin(), result.end() - count);
+      }
+    }
+
+    return result;
+  }
+}
+
+/**
+ * @brief Reads live records of a series with timestamps in the range [begin, end) and
+ * temperatures within [low, high].
+ *
+ * Records are numbered by sequence among all records of their timestamp before being filtered
+ * by temperature, so only whole timestamps are skipped by zone.
+ *
+ * @param series
+ *   Name of the component
+ * @param state
+ *   Parts of the series
+ * @param begin
+ *   First timestamp of the range
+ * @param end
+ *   Timestamp one past the range
+ * @param low
+ *   Lowest matching temperature
+ * @param high
+ *   Highest matching temperature
+ *
+ * @return std::vector<Measurement>
+ *   Records ordered by timestamp
+ *
+ * @throws std::runtime_error
+ *   If a run or a partition cannot be read
+ */
+std::vector<Measurement> StorageEngine::collectRange(const std::string& series,
+                                                     const SeriesState& state, long long begin,
+                                                     long long end, double low,
+                                                     double high) const {
+  SegmentLog& log = SegmentLog::getInstance();
+  auto inRange = [&](const Measurement& m) { return m.timestamp >= begin && m.timestamp < end; };
+
+  std::vector<std::vector<Measurement>> parts(1);
+  for (const auto& [partition, count] : state.partitions) {
+    if (partition + PARTITION_SECONDS <= begin || partition >= end) {
+      continue;
+    }
+
+    std::vector<Measurement> records;
+    ChunkStore(partition).readMatching(series, count, begin, end, low, high, records);
+    std::copy_if(records.begin(), records.end(), std::back_inserter(parts[0]), inRange);
+  }
+
+  for (const auto& run : state.runs) {
+    std::string name = getRunName(series, run.lsn);
+    auto [first, last] = findTimestamps(log.view(name, 0, run.count), begin, end);
+    std::vector<Measurement> records = log.read(name, first, last);
+    parts.emplace_back();
+    std::copy_if(records.begin(), records.end(), std::back_inserter(parts.back()), inRange);
+  }
+
+  for (const auto& records : state.buffered) {
+    parts.emplace_back();
+    std::copy_if(records.begin(), records.end(), std::back_inserter(parts.back()), inRange);
+  }
+
+  std::vector<uint64_t> partLsns = getPartLsns(state);
+  MergeIterator merged(std::move(parts));
+  std::vector<Measurement> records;
+  std::vector<uint64_t> lsns;
+  Measurement record;
+  size_t part;
+  while (merged.next(record, part)) {
+    records.push_back(record);
+    lsns.push_back(partLsns[part]);
+  }
+
+  std::vector<Measurement> result;
+  for (const auto& m : dropDeleted(records, lsns, state.tombstones)) {
+    if (m.temperature >= low && m.temperature <= high) {
+      result.push_back(m);
+    }
+  }
+
+  return result;
+}
+
+/**
+ * @brief Drops the records hidden by tombstones from merged records of a series.
+ *
+ * @param records
+ *   Records ordered by timestamp and, within a timestamp, by sequence
+ * @param lsns
+ *   Log sequence number of the part holding each record
+ * @param tombstones
+ *   Tombstones of the series
+ *
+ * @return std::vector<Measurement>
+ *   Live records, each carrying its sequence
+ */
+std::vector<Measurement> StorageEngine::dropDeleted(const std::vector<Measurement>& records,
+                                                    const std::vector<uint64_t>& lsns,
+                                                    const std::vector<Tombstone>& tombstones) {
+  std::vector<Measurement> live;
+  size_t sequence = 0;
+  for (size_t i = 0; i < records.size(); ++i) {
+    sequence = i > 0 && records[i].timestamp == records[i - 1].timestamp ? sequence + 1 : 0;
+    if (!isDeleted(tombstones, records[i].timestamp, sequence, lsns[i])) {
+      live.push_back(records[i]);
+      live.back().sequence = sequence;
+    }
+  }
+
+  return live;
+}
+
+/**
+ * @brief Checks whether a record is hidden by one of the tombstones.
+ *
+ * @param tombstones
+ *   Tombstones of the series
+ * @param timestamp
+ *   Timestamp of the record
+ * @param sequence
+ *   Sequence of the record among the records of its timestamp
+ * @param lsn
+ *   Log sequence number of the part holding the record
+ *
+ * @return bool
+ *   True if the record is deleted
+ */
+bool StorageEngine::isDeleted(const std::vector<Tombstone>& tombstones, long long timestamp,
+                              size_t sequence, uint64_t lsn) {
+  for (const auto& tombstone : tombstones) {
+    if (lsn > tombstone.lsn) {
+      continue;
+    }
+
+    bool afterFirst = timestamp > tombstone.first ||
+                      (timestamp == tombstone.first && sequence >= tombstone.firstSequence);
+    bool beforeLast = timestamp < tombstone.last ||
+                      (timestamp == tombstone.last && sequence <= tombstone.lastSequence);
+    if (afterFirst && beforeLast) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief Gets the log sequence number every part of a series is compared with by tombstones.
+ *
+ * @param state
+ *   Parts of the series
+ *
+ * @return std::vector<uint64_t>
+ *   Number of every part, laid out as by collectParts()
+ */
+std::vector<uint64_t> StorageEngine::getPartLsns(const SeriesState& state) {
+  std::vector<uint64_t> lsns(1, 0);
+  for (const auto& run : state.runs) {
+    lsns.push_back(run.lsn);
+  }
+  lsns.insert(lsns.end(), state.buffered.size(), UINT64_MAX);
+
+  return lsns;
+}
+
+/**
+ * @brief Durably writes the manifest.
+ *
+ * @throws std::runtime_error
+ *   If the manifest cannot be written
+ */
+void StorageEngine::saveManifest() {
+  nlohmann::json manifest = {{"chunks", nlohmann::json::object()},
+                             {"compacted", nlohmann::json::object()}};
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [series, counts] : partitions) {
+      nlohmann::json& entry = manifest["chunks"][series] = nlohmann::json::object();
+      for (const auto& [partition, count] : counts) {
+        entry[std::to_string(partition)] = count;
+      }
+    }
+    manifest["compacted"] = compactedLsn;
+  }
+
+  writeFileDurably(getManifestPath(), manifest.dump(4));
+}
+
+/**
+ * @brief Durably writes the tombstones.
+ *
+ * @throws std::runtime_error
+ *   If the tombstones cannot be written
+ */
+void StorageEngine::saveTombstones() {
+  nlohmann::json list = nlohmann::json::array();
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& [series, entries] : tombstones) {
+      for (const auto& tombstone : entries) {
+        list.push_back({{"series", series},
+                        {"first", tombstone.first},
+                        {"firstSequence", tombstone.firstSequence},
+                        {"last", tombstone.last},
+                        {"lastSequence", tombstone.lastSequence},
+                        {"lsn", tombstone.lsn}});
+      }
+    }
+  }
+
+  writeFileDurably(getTombstonesPath(), list.dump(4));
+}
+
+/**
+ * @brief Loads the tombstones written by saveTombstones().
+ *
+ * Tombstones of older versions only hold timestamps; they cover every record of those timestamps
+ * and are purged by recovery.
+ *
+ * @throws std::runtime_error
+ *   If the tombstones file exists but is unreadable
+ */
+void StorageEngine::loadTombstones() {
+  try {
+    std::ifstream file(getTombstonesPath());
+    if (file) {
+      nlohmann::json list;
+      file >> list;
+      for (const auto& entry : list) {
+        tombstones[entry["series"].get<std::string>()].push_back(
+            {entry["first"].get<long long>(), entry.value("firstSequence", size_t(0)),
+             entry["last"].get<long long>(), entry.value("lastSequence", SIZE_MAX),
+             entry.value("lsn", UINT64_MAX)});
+      }
+    }
+  }
+  catch (...) {
+    throw std::runtime_error("Tombstones are unreadable: " + getTombstonesPath());
+  }
+}
+
+/**
+ * @brief Gets segment name of a run.
+ *
+ * @param series
+ *   Name of the component
+ * @param lsn
+ *   Newest log sequence number of the run
+ *
+ * @return std::string
+ *   Name of the run segment
+ */
+std::string StorageEngine::getRunName(const std::string& series, uint64_t lsn) {
+  char suffix[LSN_DIGITS + 2];
+  std::snprintf(suffix, sizeof(suffix), ".%020llu", static_cast<unsigned long long>(lsn));
+
+  return series + suffix;
+}
+
+/**
+ * @brief Gets the partition holding a timestamp.
+ *
+ * @param timestamp
+ *   Timestamp of a record
+ *
+ * @return int64_t
+ *   First timestamp of the partition
+ */
+int64_t StorageEngine::getPartition(long long timestamp) {
+  int64_t offset = timestamp % PARTITION_SECONDS;
+  if (offset < 0) {
+    offset += PARTITION_SECONDS;
+  }
+
+  return timestamp - offset;
+}
+
+/**
+ * @brief Gets path to the manifest.
+ *
+ * @return std::string
+ *   Full path to the manifest
+ */
+std::string StorageEngine::getManifestPath() const {
+  return SegmentLog::getInstance().getSegmentDirectory() + "/" + MANIFEST_FILENAME;
+}
+
+/**
+ * @brief Gets path to the tombstones file.
+ *
+ * @return std::string
+ *   Full path to the tombstones file
+ */
+std::string StorageEngine::getTombstonesPath() const {
+  return SegmentLog::getInstance().getSegmentDirectory() + "/" + TOMBSTONES_FILENAME;
+}
@@ -0,0 +1,458 @@
+// Standard library headers
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <unistd.h>
+
+// Third-party libraries
+#include <nlohmann/json.hpp>
+
+// Project headers
+#include "config/config_loader.h"
+#include "storage/write_ahead_log.h"
+#include "utils/utils.h"
+
+/**
+ * @brief Size of the fixed part of a log entry: checksum, length, LSN, timestamp, temperature.
+ */
+static constexpr size_t ENTRY_HEADER_SIZE = 4 + 4 + 8 + 8 + 8;
+
+/**
+ * @brief Encodes a log entry and appends it to a buffer.
+ *
+ * Entry layout: checksum, length of the rest, LSN, timestamp, temperature, component name.
+ *
+ * @param out
+ *   Buffer receiving the entry
+ * @param lsn
+ *   Log sequence number of the record
+ * @param record
+ *   Measurement to encode
+ */
+static void encodeEntry(std::string& out, uint64_t lsn, const Measurement& record) {
+  uint32_t length = ENTRY_HEADER_SIZE - 8 + record.component.size();
+  int64_t timestamp = record.timestamp;
+
+  std::string entry(ENTRY_HEADER_SIZE + record.component.size(), '\0');
+  std::memcpy(&entry[4], &length, 4);
+  std::memcpy(&entry[8], &lsn, 8);
+  std::memcpy(&entry[16], &timestamp, 8);
+  std::memcpy(&entry[24], &record.temperature, 8);
+  std::memcpy(&entry[32], record.component.data(), record.component.size());
+
+  uint32_t checksum = computeChecksum(entry.data() + 4, entry.size() - 4);
+  std::memcpy(&entry[0], &checksum, 4);
+
+  out += entry;
+}
+
+/**
+ * @brief Gets the singleton instance of WriteAheadLog.
+ *
+ * @return WriteAheadLog&
+ *   Reference to the singleton instance of WriteAheadLog
+ */
+WriteAheadLog& WriteAheadLog::getInstance() {
+  static WriteAheadLog instance;
+
+  return instance;
+}
+
+/**
+ * @brief Constructor loads the checkpoint, finds the last intact entry and starts the flusher
+ * thread.
+ *
+ * A torn entry left at the end of the log by a crash is cut off, so that new entries appended
+ * after it stay readable.
+ *
+ * @throws std::runtime_error
+ *   If the log file cannot be opened
+ */
+WriteAheadLog::WriteAheadLog()
+    : fd(-1), policy(parsePolicy(ConfigLoader::WAL_FSYNC)),
+      interval(ConfigLoader::WAL_FSYNC_INTERVAL_MS), logSize(0), checkpointLsn(0), nextLsn(1),
+      writtenLsn(0), durableLsn(0), flushRequested(false), stopping(false), failed(false) {
+  ensureDataDirectoryExists(getDataDirectory());
+  ensureDataDirectoryExists(getWalDirectory());
+
+  std::string logPath = getWalDirectory() + "/" + LOG_FILENAME;
+  fd = open(logPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd == -1) {
+    throw std::runtime_error("Cannot open write-ahead log: " + logPath);
+  }
+
+  try {
+    std::ifstream file(getWalDirectory() + "/" + CHECKPOINT_FILENAME);
+    if (file) {
+      file >> checkpointState;
+      checkpointLsn = checkpointState["lsn"].get<uint64_t>();
+    }
+  }
+  catch (...) {
+    std::cerr << "Warning: write-ahead log checkpoint is unreadable, replaying without it.\n";
+    checkpointState = nlohmann::json();
+    checkpointLsn = 0;
+  }
+
+  uint64_t lastLsn = checkpointLsn;
+  logSize = scan([&](uint64_t lsn, const Measurement&) { lastLsn = std::max(lastLsn, lsn); });
+  if (ftruncate(fd, logSize) != 0) {
+    throw std::runtime_error("Cannot repair write-ahead log: " + logPath);
+  }
+
+  nextLsn = lastLsn + 1;
+  writtenLsn = lastLsn;
+  durableLsn = lastLsn;
+
+  flusher = std::thread(&WriteAheadLog::flusherLoop, this);
+}
+
+/**
+ * @brief Stops the flusher thread after committing all pending records.
+ */
+WriteAheadLog::~WriteAheadLog() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  pendingCv.notify_one();
+
+  if (flusher.joinable()) {
+    flusher.join();
+  }
+
+  if (fd != -1) {
+    close(fd);
+  }
+}
+
+/**
+ * @brief Appends a record to the log and waits until it is committed according to the policy.
+ *
+ * @param record
+ *   Measurement to log
+ *
+ * @return uint64_t
+ *   Log sequence number assigned to the record
+ *
+ * @throws std::runtime_error
+ *   If the log cannot be written
+ */
+uint64_t WriteAheadLog::append(const Measurement& record) {
+  uint64_t lsn = enqueue(record);
+  waitFor(lsn);
+
+  return lsn;
+}
+
+/**
+ * @brief Assigns a sequence number to a record and queues it for the flusher without waiting.
+ *
+ * @param record
+ *   Measurement to log
+ *
+ * @return uint64_t
+ *   Log sequence number assigned to the record
+ *
+ * @throws std::runtime_error
+ *   If the log is no longer writable
+ */
+uint64_t WriteAheadLog::enqueue(const Measurement& record) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (failed) {
+    throw std::runtime_error("Write-ahead log is not writable.");
+  }
+
+  uint64_t lsn = nextLsn++;
+  encodeEntry(pending, lsn, record);
+  pendingCv.notify_one();
+
+  return lsn;
+}
+
+/**
+ * @brief Waits until a queued record is committed according to the policy.
+ *
+ * @param lsn
+ *   Log sequence number returned by enqueue()
+ *
+ * @throws std::runtime_error
+ *   If the log cannot be written
+ */
+void WriteAheadLog::waitFor(uint64_t lsn) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (policy == FsyncPolicy::ALWAYS) {
+    committedCv.wait(lock, [&] { return durableLsn >= lsn || failed; });
+  }
+  else if (policy == FsyncPolicy::OS) {
+    committedCv.wait(lock, [&] { return writtenLsn >= lsn || failed; });
+  }
+
+  if (failed) {
+    throw std::runtime_error("Failed to write write-ahead log.");
+  }
+}
+
+/**
+ * @brief Writes and fsyncs all pending records regardless of the policy.
+ *
+ * @throws std::runtime_error
+ *   If the log cannot be written
+ */
+void WriteAheadLog::flush() {
+  std::unique_lock<std::mutex> lock(mutex);
+  uint64_t target = nextLsn - 1;
+  if (durableLsn >= target && !failed) {
+    return;
+  }
+
+  flushRequested = true;
+  pendingCv.notify_one();
+  committedCv.wait(lock, [&] { return durableLsn >= target || failed; });
+
+  if (failed) {
+    throw std::runtime_error("Failed to write write-ahead log.");
+  }
+}
+
+/**
+ * @brief Passes every intact record logged after the last checkpoint to a callback.
+ *
+ * @param apply
+ *   Called with the sequence number and the record, in log order
+ *
+ * @return size_t
+ *   Number of replayed records
+ */
+size_t WriteAheadLog::replay(const std::function<void(uint64_t, const Measurement&)>& apply) {
+  size_t replayed = 0;
+  scan([&](uint64_t lsn, const Measurement& record) {
+    if (lsn > checkpointLsn) {
+      apply(lsn, record);
+      ++replayed;
+    }
+  });
+
+  return replayed;
+}
+
+/**
+ * @brief Records that every logged record is stored durably elsewhere and empties the log.
+ *
+ * The caller must make sure no record is appended while the checkpoint is taken.
+ *
+ * @throws std::runtime_error
+ *   If the log or the checkpoint cannot be written
+ */
+void WriteAheadLog::checkpoint() {
+  flush();
+
+  std::lock_guard<std::mutex> lock(mutex);
+  checkpointState = nlohmann::json{{"lsn", durableLsn}};
+  writeFileDurably(getWalDirectory() + "/" + CHECKPOINT_FILENAME, checkpointState.dump(4));
+  checkpointLsn = durableLsn;
+
+  if (ftruncate(fd, 0) != 0) {
+    throw std::runtime_error("Cannot truncate write-ahead log.");
+  }
+  logSize = 0;
+}
+
+/**
+ * @brief Checks whether the log has grown past CHECKPOINT_BYTES.
+ *
+ * @return bool
+ *   True if a checkpoint should be taken
+ */
+bool WriteAheadLog::needsCheckpoint() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return logSize + pending.size() >= CHECKPOINT_BYTES;
+}
+
+/**
+ * @brief Gets content of the checkpoint file loaded at startup or written last.
+ *
+ * @return nlohmann::json
+ *   Checkpoint object, null if there is none
+ */
+nlohmann::json WriteAheadLog::getCheckpoint() {
+  std::lock_guard<std::mutex> lock(mutex);
+
+  return checkpointState;
+}
+
+/**
+ * @brief Parses fsync policy name used in the configuration file.
+ *
+ * @param name
+ *   One of "always", "interval" or "os"
+ *
+ * @return FsyncPolicy
+ *   Parsed policy
+ *
+ * @throws std::invalid_argument
+ *   If the name is not a known policy
+ */
+FsyncPolicy WriteAheadLog::parsePolicy(const std::string& name) {
+  if (name == "always") {
+    return FsyncPolicy::ALWAYS;
+  }
+  if (name == "interval") {
+    return FsyncPolicy::INTERVAL;
+  }
+  if (name == "os") {
+    return FsyncPolicy::OS;
+  }
+
+  throw std::invalid_argument("Unknown fsync policy: " + name);
+}
+
+/**
+ * @brief Reads the log file and passes every intact entry to a callback.
+ *
+ * Reading stops at the first torn or corrupted entry.
+ *
+ * @param visit
+ *   Called with the sequence number and the record of every entry
+ *
+ * @return uint64_t
+ *   Size of the intact part of the log in bytes
+ */
+uint64_t WriteAheadLog::scan(const std::function<void(uint64_t, const Measurement&)>& visit) {
+  std::ifstream in(getWalDirectory() + "/" + LOG_FILENAME, std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  size_t offset = 0;
+  while (offset + ENTRY_HEADER_SIZE <= data.size()) {
+    uint32_t checksum, length;
+    std::memcpy(&checksum, &data[offset], 4);
+    std::memcpy(&length, &data[offset + 4], 4);
+
+    size_t entrySize = 8 + (size_t)length;
+    if (length < ENTRY_HEADER_SIZE - 8 || offset + entrySize > data.size() ||
+        computeChecksum(&data[offset + 4], entrySize - 4) != checksum) {
+      break;
+    }
+
+    uint64_t lsn;
+    int64_t timestamp;
+    Measurement record;
+    std::memcpy(&lsn, &data[offset + 8], 8);
+    std::memcpy(&timestamp, &data[offset + 16], 8);
+    std::memcpy(&record.temperature, &data[offset + 24], 8);
+    record.component = data.substr(offset + ENTRY_HEADER_SIZE, entrySize - ENTRY_HEADER_SIZE);
+    record.timestamp = timestamp;
+    offset += entrySize;
+
+    visit(lsn, record);
+  }
+
+  return offset;
+}
+
+/**
+ * @brief Background loop writing pending batches to the log file.
+ *
+ * Everything appended while the previous batch was being written ends up in the next batch,
+ * so concurrent appenders share a single write and a single fsync.
+ */
+void WriteAheadLog::flusherLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  auto ready = [this] {
+    return stopping || flushRequested || (policy != FsyncPolicy::INTERVAL && !pending.empty());
+  };
+
+  while (true) {
+    if (policy == FsyncPolicy::INTERVAL) {
+      pendingCv.wait_for(lock, interval, ready);
+    }
+    else {
+      pendingCv.wait(lock, ready);
+    }
+
+    bool sync = policy != FsyncPolicy::OS || flushRequested || stopping;
+    if (pending.empty() && (!sync || durableLsn == writtenLsn)) {
+      flushRequested = false;
+      if (stopping) {
+        break;
+      }
+      continue;
+    }
+
+    std::string batch;
+    batch.swap(pending);
+    uint64_t batchLsn = nextLsn - 1;
+    flushRequested = false;
+
+    lock.unlock();
+    bool ok = writeBatch(batch, sync);
+    lock.lock();
+
+    if (ok) {
+      writtenLsn = batchLsn;
+      logSize += batch.size();
+      if (sync) {
+        durableLsn = batchLsn;
+      }
+    }
+    else {
+      failed = true;
+    }
+    committedCv.notify_all();
+
+    if (stopping && pending.empty()) {
+      break;
+    }
+  }
+}
+
+/**
+ * @brief Writes a batch to the log file.
+ *
+ * @param batch
+ *   Encoded records
+ * @param sync
+ *   True to fsync after writing
+ *
+ * @return bool
+ *   True on success
+ */
+bool WriteAheadLog::writeBatch(const std::string& batch, bool sync) {
+  size_t written = 0;
+  while (written < batch.size()) {
+    ssize_t res = write(fd, batch.data() + written, batch.size() - written);
+    if (res == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Error: Cannot write write-ahead log: " << std::strerror(errno) << "\n";
+
+      return false;
+    }
+    written += res;
+  }
+
+  if (sync && fdatasync(fd) != 0) {
+    std::cerr << "Error: Cannot sync write-ahead log: " << std::strerror(errno) << "\n";
+
+    return false;
+  }
+
+  return true;
+}
+
+/**
+ * @brief Gets path to the directory holding the log and the checkpoint.
+ *
+ * @return std::string
+ *   Full path to the WAL directory
+ */
+std::string WriteAheadLog::getWalDirectory() const {
+  return getDataDirectory() + "/" + WAL_DIRNAME;
+}
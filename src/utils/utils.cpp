@@ -1,7 +1,10 @@
 // Standard library headers
+#include <cstdio>
+#include <fcntl.h>
 #include <iostream>
 #include <libgen.h>
 #include <limits.h>
+#include <stdexcept>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -16,8 +19,9 @@
  */
 std::string getDataDirectory() {
   char path[PATH_MAX];
-  ssize_t count = readlink("/proc/self/exe", path, PATH_MAX);
+  ssize_t count = readlink("/proc/self/exe", path, PATH_MAX - 1);
   if (count != -1) {
+    path[count] = '\0';
     std::string confDir = dirname(path);
 
     return std::string(dirname(confDir.data())) + "/data";
@@ -39,4 +43,54 @@ void ensureDataDirectoryExists(const std::string& dataPath) {
       std::cerr << "Error: Cannot create directory '" << dataPath << "'.\n";
     }
   }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Computes CRC-32 checksum of a byte range.
+ *
+ * @param data
+ *   Pointer to the first byte
+ * @param size
+ *   Number of bytes
+ *
+ * @return uint32_t
+ *   CRC-32 (IEEE) of the range
+ */
+uint32_t computeChecksum(const char* data, size_t size) {
+  uint32_t crc = 0xFFFFFFFF;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= static_cast<uint8_t>(data[i]);
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+  }
+
+  return ~crc;
+}
+
+/**
+ * @brief Writes a small file so that it either fully replaces the old one or not at all.
+ *
+ * @param path
+ *   Destination path
+ * @param content
+ *   New file content
+ *
+ * @throws std::runtime_error
+ *   If the file cannot be written
+ */
+void writeFileDurably(const std::string& path, const std::string& content) {
+  std::string tmpPath = path + ".tmp";
+  int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1) {
+    throw std::runtime_error("Cannot open file for writing: " + tmpPath);
+  }
+
+  bool ok = write(fd, content.data(), content.size()) == (ssize_t)content.size() && fsync(fd) == 0;
+  close(fd);
+
+  if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    throw std::runtime_error("Failed to write file: " + path);
+  }
+}
@@ -0,0 +1,260 @@
+// Standard library headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// System headers
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Project headers
+#include "config/config_loader.h"
+#include "inputs/ohm_collector.h"
+
+/**
+ * @brief OHM document with a CPU package temperature of 55 °C.
+ */
+static const std::string DOCUMENT = R"({"Children": [{"Text": "PC", "Children": [
+  {"Text": "Intel Core i7", "Children": [
+    {"Text": "Temperatures", "Children": [{"Text": "CPU Package", "Value": "55.0 °C"}]}]}]}]})";
+
+/**
+ * @brief Time in milliseconds a snapshot waits for the hosts in these tests.
+ */
+static constexpr int TIMEOUT_MS = 200;
+
+static int failures = 0;
+
+/**
+ * @brief Reports a failed expectation without stopping the test.
+ *
+ * @param condition
+ *   Expectation
+ * @param message
+ *   Description printed if the expectation does not hold
+ */
+static void check(bool condition, const std::string& message) {
+  if (!condition) {
+    std::cerr << "FAILED: " << message << "\n";
+    ++failures;
+  }
+}
+
+/**
+ * @brief Checks whether one of the messages contains a text.
+ *
+ * @param messages
+ *   Messages to search
+ * @param text
+ *   Text to look for
+ *
+ * @return bool
+ *   True if a message contains the text
+ */
+static bool contains(const std::vector<std::string>& messages, const std::string& text) {
+  return std::any_of(messages.begin(), messages.end(), [&](const std::string& message) {
+    return message.find(text) != std::string::npos;
+  });
+}
+
+/**
+ * @brief HTTP server on a loopback port answering every request with the OHM document after a
+ * delay.
+ */
+class StubServer {
+public:
+  /**
+   * @brief Starts listening on a free loopback port.
+   *
+   * @param delayMs
+   *   Time in milliseconds before every response is sent
+   */
+  explicit StubServer(int delayMs) : delayMs(delayMs), stopped(false) {
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (listener == -1 || bind(listener, (sockaddr*)&address, length) != 0 ||
+        listen(listener, 8) != 0 || getsockname(listener, (sockaddr*)&address, &length) != 0) {
+      throw std::runtime_error("Cannot start the stub server");
+    }
+    port = ntohs(address.sin_port);
+    worker = std::thread(&StubServer::serve, this);
+  }
+
+  /**
+   * @brief Stops accepting connections and closes the port.
+   */
+  ~StubServer() {
+    stopped = true;
+    worker.join();
+    close(listener);
+  }
+
+  /**
+   * @brief Gets the URL of the document.
+   *
+   * @return std::string
+   *   URL on the loopback interface
+   */
+  std::string getUrl() const {
+    return "http://127.0.0.1:" + std::to_string(port) + "/data.json";
+  }
+
+private:
+  /**
+   * @brief Answers connections until the server is stopped.
+   */
+  void serve() {
+    while (!stopped) {
+      pollfd ready{listener, POLLIN, 0};
+      if (poll(&ready, 1, 20) <= 0) {
+        continue;
+      }
+
+      int client = accept(listener, nullptr, nullptr);
+      if (client == -1) {
+        continue;
+      }
+
+      std::string request;
+      char buffer[1024];
+      ssize_t received;
+      while (request.find("\r\n\r\n") == std::string::npos &&
+             (received = recv(client, buffer, sizeof(buffer), 0)) > 0) {
+        request.append(buffer, received);
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+      std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                             "Content-Length: " +
+                             std::to_string(DOCUMENT.size()) + "\r\nConnection: close\r\n\r\n" +
+                             DOCUMENT;
+      send(client, response.data(), response.size(), MSG_NOSIGNAL);
+      close(client);
+    }
+  }
+
+  int delayMs;
+  int listener;
+  int port;
+  std::atomic<bool> stopped;
+  std::thread worker;
+};
+
+/**
+ * @brief Gets the URL of a loopback port nothing listens on.
+ *
+ * @return std::string
+ *   URL whose connection is refused
+ */
+static std::string getClosedUrl() {
+  int probe = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+  bind(probe, (sockaddr*)&address, length);
+  getsockname(probe, (sockaddr*)&address, &length);
+  close(probe);
+
+  return "http://127.0.0.1:" + std::to_string(ntohs(address.sin_port)) + "/data.json";
+}
+
+/**
+ * @brief A host that answers in time yields one "<Component>@<Host>" series per component.
+ */
+static void testSeriesNaming() {
+  StubServer server(0);
+  OHMCollector collector({{"lab1", server.getUrl()}}, TIMEOUT_MS);
+
+  std::vector<std::string> errors;
+  auto measurements = collector.getSnapshot({"CPU", "GPU"}, errors);
+
+  check(measurements.size() == 1, "one measurement from lab1");
+  if (!measurements.empty()) {
+    check(measurements[0].component == "CPU@lab1", "series named CPU@lab1");
+    check(measurements[0].temperature == 55.0, "temperature read from the document");
+  }
+  check(contains(errors, "GPU@lab1"), "missing GPU reported under its series name");
+}
+
+/**
+ * @brief A host that is down is reported while the other hosts are still measured.
+ */
+static void testHostDown() {
+  StubServer server(0);
+  OHMCollector collector({{"lab1", server.getUrl()}, {"lab2", getClosedUrl()}}, TIMEOUT_MS);
+
+  std::vector<std::string> errors;
+  auto measurements = collector.getSnapshot({"CPU"}, errors);
+
+  check(measurements.size() == 1 && measurements[0].component == "CPU@lab1",
+        "lab1 measured although lab2 is down");
+  check(contains(errors, "lab2: "), "lab2 reported as down");
+}
+
+/**
+ * @brief A slow host does not delay the snapshot; its response is collected by a later one.
+ */
+static void testTimeout() {
+  StubServer slow(3 * TIMEOUT_MS);
+  StubServer fast(0);
+  OHMCollector collector({{"fast", fast.getUrl()}, {"slow", slow.getUrl()}}, TIMEOUT_MS);
+
+  std::vector<std::string> errors;
+  auto begin = std::chrono::steady_clock::now();
+  auto measurements = collector.getSnapshot({"CPU"}, errors);
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - begin);
+
+  check(elapsed.count() < 2 * TIMEOUT_MS, "snapshot returns after the timeout");
+  check(measurements.size() == 1 && measurements[0].component == "CPU@fast",
+        "fast host measured");
+  check(contains(errors, "slow: no response within"), "slow host reported as late");
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(4 * TIMEOUT_MS));
+  errors.clear();
+  measurements = collector.getSnapshot({"CPU"}, errors);
+
+  check(contains(errors, "slow: previous request still in flight"),
+        "no second request sent to the slow host");
+  check(std::any_of(measurements.begin(), measurements.end(),
+                    [](const Measurement& m) { return m.component == "CPU@slow"; }),
+        "late response collected by the next snapshot");
+}
+
+/**
+ * @brief Runs the OHMCollector tests against stub servers on the loopback interface.
+ *
+ * @return int
+ *   0 if every expectation holds, 1 otherwise
+ */
+int main() {
+  // A proxy from the environment must not intercept the loopback requests.
+  setenv("no_proxy", "127.0.0.1", 1);
+  ConfigLoader::CPU = "Intel";
+  ConfigLoader::GPU = "NVIDIA";
+
+  testSeriesNaming();
+  testHostDown();
+  testTimeout();
+
+  if (failures > 0) {
+    std::cerr << failures << " expectation(s) failed.\n";
+
+    return 1;
+  }
+  std::cout << "All OHMCollector tests passed.\n";
+
+  return 0;
+}